@@ -22,17 +22,41 @@ void zint_symbol_deleter::operator()(zint_symbol* p) const noexcept
 }
 #else
 struct zint_symbol {};
+#ifdef ZXING_EXPERIMENTAL_API
+void zint_symbol_deleter::operator()(zint_symbol*) const noexcept {}
+#endif
 #endif
 
+#include <array>
 #include <cmath>
 #include <list>
 #include <map>
+#include <mutex>
 #include <utility>
 
 namespace ZXing {
 
+/**
+ * The content of a Barcode does not change after construction, except in the few places that replace the TextCache
+ * as well. This way every text(mode) and the content type are rendered at most once, even if called concurrently.
+ */
+struct Result::TextCache
+{
+	static constexpr int MODE_COUNT = static_cast<int>(TextMode::Escaped) + 1;
+
+	std::once_flag textFlags[MODE_COUNT];
+	std::string texts[MODE_COUNT];
+	std::once_flag typeFlag;
+	ContentType type = ContentType::Text;
+
+	// the GS1 elements as {AI, value, end of value} offsets into the bytes, collected in the pass that renders the HRI
+	// text. Views could dangle, since copies of a Barcode share this cache but not their bytes.
+	std::vector<std::array<int, 3>> gs1Elements;
+};
+
 Result::Result(const std::string& text, int y, int xStart, int xStop, BarcodeFormat format, SymbologyIdentifier si, Error error, bool readerInit)
 	: _content({ByteArray(text)}, si),
+	  _textCache(std::make_shared<TextCache>()),
 	  _error(error),
 	  _position(Line(y, xStart, xStop)),
 	  _format(format),
@@ -41,6 +65,7 @@ Result::Result(const std::string& text, int y, int xStart, int xStop, BarcodeFor
 
 Result::Result(DecoderResult&& decodeResult, DetectorResult&& detectorResult, BarcodeFormat format)
 	: _content(std::move(decodeResult).content()),
+	  _textCache(std::make_shared<TextCache>()),
 	  _error(std::move(decodeResult).error()),
 	  _position(std::move(detectorResult).position()),
 	  _sai(decodeResult.structuredAppend()),
@@ -48,10 +73,11 @@ Result::Result(DecoderResult&& decodeResult, DetectorResult&& detectorResult, Ba
 	  _lineCount(decodeResult.lineCount()),
 	  _isMirrored(decodeResult.isMirrored()),
 	  _readerInit(decodeResult.readerInit())
+{
 #ifdef ZXING_EXPERIMENTAL_API
-	  , _symbol(std::make_shared<BitMatrix>(std::move(detectorResult).bits()))
+	if (!detectorResult.bits().empty())
+		symbol(std::move(detectorResult).bits());
 #endif
-{
 	if (decodeResult.versionNumber())
 		snprintf(_version, 4, "%d", decodeResult.versionNumber());
 	snprintf(_ecLevel, 4, "%s", decodeResult.ecLevel().data());
@@ -80,12 +106,39 @@ ByteArray Result::bytesECI() const
 
 std::string Result::text(TextMode mode) const
 {
-	return _content.text(mode);
+	return std::string(textView(mode));
 }
 
 std::string Result::text() const
 {
-	return text(_readerOpts.textMode());
+	return text(_textMode);
+}
+
+std::string_view Result::textView(TextMode mode) const
+{
+	if (!_textCache) // default constructed, i.e. empty
+		return {};
+
+	auto& cache = *_textCache;
+	int i = static_cast<int>(mode);
+	std::call_once(cache.textFlags[i], [&] {
+		if (mode != TextMode::HRI) {
+			cache.texts[i] = _content.text(mode);
+			return;
+		}
+		std::vector<GS1Element> elements;
+		cache.texts[i] = _content.textHRI(elements);
+		auto base = reinterpret_cast<const char*>(_content.bytes.data());
+		for (auto& [ai, value] : elements)
+			cache.gs1Elements.push_back({narrow_cast<int>(ai.data() - base), narrow_cast<int>(value.data() - base),
+										 narrow_cast<int>(value.data() + value.size() - base)});
+	});
+	return cache.texts[i];
+}
+
+std::string_view Result::textView() const
+{
+	return textView(_textMode);
 }
 
 std::string Result::ecLevel() const
@@ -95,7 +148,25 @@ std::string Result::ecLevel() const
 
 ContentType Result::contentType() const
 {
-	return _content.type();
+	if (!_textCache)
+		return _content.type();
+
+	auto& cache = *_textCache;
+	std::call_once(cache.typeFlag, [&] { cache.type = _content.type(); });
+	return cache.type;
+}
+
+std::vector<GS1Element> Result::gs1Elements() const
+{
+	std::vector<GS1Element> res;
+	if (!_textCache)
+		return res;
+
+	textView(TextMode::HRI); // collects the element offsets
+	auto bytes = _content.bytes.asString();
+	for (auto [ai, value, end] : _textCache->gs1Elements)
+		res.push_back({bytes.substr(ai, value - ai), bytes.substr(value, end - value)});
+	return res;
 }
 
 bool Result::hasECI() const
@@ -136,9 +207,11 @@ std::string Result::version() const
 
 Result& Result::setReaderOptions(const ReaderOptions& opts)
 {
-	if (opts.characterSet() != CharacterSet::Unknown)
+	if (opts.characterSet() != CharacterSet::Unknown && opts.characterSet() != _content.defaultCharset) {
 		_content.defaultCharset = opts.characterSet();
-	_readerOpts = opts;
+		_textCache = std::make_shared<TextCache>();
+	}
+	_textMode = opts.textMode();
 	return *this;
 }
 
@@ -151,6 +224,8 @@ void Result::symbol(BitMatrix&& bits)
 
 ImageView Result::symbol() const
 {
+	if (!_symbol)
+		return {};
 	return {_symbol->row(0).begin(), _symbol->width(), _symbol->height(), ImageFormat::Lum};
 }
 
@@ -213,6 +288,7 @@ Barcode MergeStructuredAppendSequence(const Barcodes& barcodes)
 	Barcode res = allBarcodes.front();
 	for (auto i = std::next(allBarcodes.begin()); i != allBarcodes.end(); ++i)
 		res._content.append(i->_content);
+	res._textCache = std::make_shared<Barcode::TextCache>();
 
 	res._position = {};
 	res._sai.index = -1;
@@ -227,15 +303,14 @@ Barcode MergeStructuredAppendSequence(const Barcodes& barcodes)
 
 Barcodes MergeStructuredAppendSequences(const Barcodes& barcodes)
 {
-	std::map<std::string, Barcodes> sas;
-	for (auto& barcode : barcodes) {
+	StructuredAppendAssembler assembler;
+	for (auto& barcode : barcodes)
 		if (barcode.isPartOfSequence())
-			sas[barcode.sequenceId()].push_back(barcode);
-	}
+			assembler.add(barcode);
 
 	Barcodes res;
-	for (auto& [id, seq] : sas) {
-		auto barcode = MergeStructuredAppendSequence(seq);
+	for (auto& id : assembler.completeSequenceIds()) {
+		auto barcode = assembler.merge(id);
 		if (barcode.isValid())
 			res.push_back(std::move(barcode));
 	}
@@ -243,4 +318,83 @@ Barcodes MergeStructuredAppendSequences(const Barcodes& barcodes)
 	return res;
 }
 
+bool StructuredAppendAssembler::add(Barcode barcode)
+{
+	if (!barcode.isPartOfSequence())
+		return false;
+
+	auto& seq = _sequences[barcode.sequenceId()];
+	int index = barcode.sequenceIndex();
+	auto [part, isNew] = seq.parts.try_emplace(index);
+	if (!isNew)
+		return false;
+
+	// the size of a PDF417 sequence without the optional segment count is only known from its last part
+	int count = barcode.sequenceSize();
+	if (count > 0 && seq.count > 0 && count != seq.count)
+		seq.mismatch = true;
+	seq.count = std::max(seq.count, count);
+	if (seq.count > 0 && seq.parts.rbegin()->first >= seq.count)
+		seq.mismatch = true;
+
+	part->second = std::move(barcode._content);
+	if (!seq.head.isPartOfSequence() || index < seq.head.sequenceIndex())
+		seq.head = std::move(barcode);
+
+	return true;
+}
+
+int StructuredAppendAssembler::add(Barcodes barcodes)
+{
+	int n = 0;
+	for (auto& barcode : barcodes)
+		n += add(std::move(barcode));
+	return n;
+}
+
+bool StructuredAppendAssembler::isComplete(const std::string& sequenceId) const
+{
+	auto i = _sequences.find(sequenceId);
+	return i != _sequences.end() && (i->second.mismatch || (i->second.count > 0 && Size(i->second.parts) == i->second.count));
+}
+
+int StructuredAppendAssembler::partCount(const std::string& sequenceId) const
+{
+	auto i = _sequences.find(sequenceId);
+	return i != _sequences.end() ? Size(i->second.parts) : 0;
+}
+
+std::vector<std::string> StructuredAppendAssembler::completeSequenceIds() const
+{
+	std::vector<std::string> res;
+	for (auto& [id, seq] : _sequences)
+		if (isComplete(id))
+			res.push_back(id);
+	return res;
+}
+
+Barcode StructuredAppendAssembler::merge(const std::string& sequenceId)
+{
+	if (!isComplete(sequenceId))
+		return {};
+
+	auto node = _sequences.extract(sequenceId);
+	auto& seq = node.mapped();
+
+	Barcode res = std::move(seq.head);
+	res._content = std::move(seq.parts.begin()->second);
+	for (auto part = std::next(seq.parts.begin()); part != seq.parts.end(); ++part)
+		res._content.append(part->second);
+	res._textCache = std::make_shared<Barcode::TextCache>();
+
+	res._position = {};
+	res._sai.index = -1;
+	res._sai.count = seq.count;
+
+	if (seq.mismatch)
+		res._error = FormatError("indices not matching the size during structured append sequence merging");
+
+	return res;
+}
+
 } // namespace ZXing
@@ -30,7 +30,10 @@ struct zint_symbol_deleter
 using unique_zint_symbol = std::unique_ptr<zint_symbol, zint_symbol_deleter>;
 #endif
 
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ZXing {
@@ -54,6 +57,7 @@ class Result
 	Result& setReaderOptions(const ReaderOptions& opts);
 
 	friend Barcode MergeStructuredAppendSequence(const Barcodes&);
+	friend class StructuredAppendAssembler;
 	friend Barcodes ReadBarcodes(const ImageView&, const ReaderOptions&);
 	friend Image WriteBarcodeToImage(const Barcode&, const WriterOptions&);
 	friend void IncrementLineCount(Barcode&);
@@ -95,6 +99,13 @@ public:
 	 */
 	std::string text() const;
 
+	/**
+	 * @brief textView returns the same as text(mode) without copying it. The text is rendered on first access and
+	 * cached. The view stays valid as long as this Barcode or a copy of it exists.
+	 */
+	std::string_view textView(TextMode mode) const;
+	std::string_view textView() const;
+
 	/**
 	 * @brief ecLevel returns the error correction level of the symbol (empty string if not applicable)
 	 */
@@ -105,6 +116,13 @@ public:
 	 */
 	ContentType contentType() const;
 
+	/**
+	 * @brief gs1Elements returns the AIs and values of GS1 content (see ContentType::GS1) as views into bytes(), so
+	 * there is no need to parse the HRI text. They are valid as long as this Barcode exists. The list is empty if the
+	 * content is not a valid GS1 element string.
+	 */
+	std::vector<GS1Element> gs1Elements() const;
+
 	/**
 	 * @brief hasECI specifies wheter or not an ECI tag was found
 	 */
@@ -175,29 +193,35 @@ public:
 	std::string version() const;
 
 #ifdef ZXING_EXPERIMENTAL_API
+	/// set the module matrix of the symbol from bits where set bits are dark modules
 	void symbol(BitMatrix&& bits);
+	/// the module matrix of the symbol, one pixel per module with dark modules black (0) and light ones white (255),
+	/// empty if there is none (e.g. for linear codes found by a reader)
 	ImageView symbol() const;
 	void zint(unique_zint_symbol&& z);
-	zint_symbol* zint() const { return _zint.get(); }
+	const zint_symbol* zint() const { return _zint.get(); }
 #endif
 
 	bool operator==(const Result& o) const;
 
 private:
+	struct TextCache;
+
 	Content _content;
+	std::shared_ptr<TextCache> _textCache; // lazily rendered text(mode) and contentType(), shared between copies
 	Error _error;
 	Position _position;
-	ReaderOptions _readerOpts; // TODO: 3.0 switch order to prevent 4 padding bytes
 	StructuredAppendInfo _sai;
 	BarcodeFormat _format = BarcodeFormat::None;
+	int _lineCount = 0;
 	char _ecLevel[4] = {};
 	char _version[4] = {};
-	int _lineCount = 0;
+	TextMode _textMode = TextMode::HRI; // the only part of the ReaderOptions a Barcode needs to remember
 	bool _isMirrored = false;
 	bool _isInverted = false;
 	bool _readerInit = false;
 #ifdef ZXING_EXPERIMENTAL_API
-	std::shared_ptr<BitMatrix> _symbol;
+	std::shared_ptr<BitMatrix> _symbol; // nullptr if there is no module matrix (e.g. for linear codes)
 	std::shared_ptr<zint_symbol> _zint;
 #endif
 };
@@ -212,4 +236,63 @@ Barcode MergeStructuredAppendSequence(const Barcodes& results);
  */
 Barcodes MergeStructuredAppendSequences(const Barcodes& barcodes);
 
+/**
+ * @brief The StructuredAppendAssembler class collects the parts of Structured Append sequences incrementally, e.g.
+ * while scanning consecutive video frames, and merges a sequence once all of its parts have been seen.
+ *
+ * Parts may arrive in any order and more than once. Of each part only the payload is kept, the meta data (format,
+ * symbology identifier, ec level, ...) of the merged Barcode is taken from the first part of the sequence.
+ */
+class StructuredAppendAssembler
+{
+	struct Sequence
+	{
+		Barcode head; // the part with the lowest index seen so far, without its content
+		std::map<int, Content> parts; // by index, which comes straight from the symbol and may be anything up to 99998
+		int count = 0; // 0 as long as the size of the sequence is unknown (see Barcode::sequenceSize())
+		bool mismatch = false; // a part index >= count or parts with different counts
+	};
+
+	std::map<std::string, Sequence> _sequences;
+
+public:
+	/**
+	 * @brief add a Barcode, returns false if it is not part of a sequence or if the part is already known.
+	 */
+	bool add(Barcode barcode);
+
+	/**
+	 * @brief add all Barcodes from the given list that are part of a sequence, returns the number of new parts.
+	 */
+	int add(Barcodes barcodes);
+
+	/**
+	 * @brief isComplete returns true if all parts of the sequence with the given id have been added.
+	 *
+	 * A sequence with parts that do not fit together (an index not smaller than the sequence size) is complete as well,
+	 * since it will never become valid. merge() then returns a Barcode with a FormatError.
+	 */
+	bool isComplete(const std::string& sequenceId) const;
+
+	/**
+	 * @brief partCount number of distinct parts of the sequence with the given id added so far.
+	 */
+	int partCount(const std::string& sequenceId) const;
+
+	/**
+	 * @brief completeSequenceIds the ids of all sequences that can be merged.
+	 */
+	std::vector<std::string> completeSequenceIds() const;
+
+	/**
+	 * @brief merge returns the merged Barcode of a complete sequence and forgets about the sequence.
+	 *
+	 * If the sequence is not complete, an invalid Barcode is returned and the parts are kept.
+	 */
+	Barcode merge(const std::string& sequenceId);
+
+	void clear() { _sequences.clear(); }
+	bool empty() const { return _sequences.empty(); }
+};
+
 } // ZXing
@@ -244,6 +244,18 @@ std::optional<QuadrilateralF> FindConcentricPatternCorners(const BitMatrix& imag
 	return res;
 }
 
+bool IsInsideFoundPattern(const std::vector<ConcentricPattern>& found, PointF p)
+{
+	// search from back to front, stop once we are out of range due to the y-coordinate
+	for (auto old = found.rbegin(); old != found.rend(); ++old) {
+		if (p.y - old->y > old->size / 2)
+			break;
+		if (distance(p, *old) < old->size / 2)
+			return true;
+	}
+	return false;
+}
+
 std::optional<PointF> FinetuneConcentricPatternCenter(const BitMatrix& image, PointF center, int range, int finderPatternSize)
 {
 	// make sure we have at least one path of white around the center
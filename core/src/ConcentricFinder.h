@@ -11,6 +11,7 @@
 #include "ZXAlgorithms.h"
 
 #include <optional>
+#include <vector>
 
 namespace ZXing {
 
@@ -108,6 +109,12 @@ struct ConcentricPattern : public PointF
 	int size = 0;
 };
 
+/**
+ * Whether p lies within one of the already found patterns. Those have to be sorted by their y-coordinate, as they are
+ * when collected during a top to bottom scan of the image.
+ */
+bool IsInsideFoundPattern(const std::vector<ConcentricPattern>& found, PointF p);
+
 template <bool E2E = false, typename PATTERN>
 std::optional<ConcentricPattern> LocateConcentricPattern(const BitMatrix& image, PATTERN pattern, PointF center, int range)
 {
@@ -108,14 +108,21 @@ std::string Content::render(bool withECI) const
 		res = symbology.toString(true);
 	ECI lastECI = ECI::Unknown;
 	auto fallbackCS = defaultCharset;
+	bool isUtf8 = false; // the guessed bytes can be copied as they are, the guess already validated them
 	if (!hasECI && fallbackCS == CharacterSet::Unknown)
-		fallbackCS = guessEncoding();
+		fallbackCS = guessEncoding(isUtf8);
 
 	ForEachECIBlock([&](ECI eci, int begin, int end) {
 		// first determine how to decode the content (choose character set)
 		//  * eci == ECI::Unknown implies !hasECI and we guess
 		//  * if !IsText(eci) the ToCharcterSet(eci) will return Unknown and we decode as binary
 		CharacterSet cs = eci == ECI::Unknown ? fallbackCS : ToCharacterSet(eci);
+		auto append = [&, copy = eci == ECI::Unknown && isUtf8](std::string& str) {
+			if (copy)
+				str.append(reinterpret_cast<const char*>(bytes.data()) + begin, end - begin);
+			else
+				TextDecoder::Append(str, bytes.data() + begin, end - begin, cs);
+		};
 
 		if (withECI) {
 			// then find the eci to report back in the ECI designator
@@ -129,14 +136,14 @@ std::string Content::render(bool withECI) const
 			lastECI = eci;
 
 			std::string tmp;
-			TextDecoder::Append(tmp, bytes.data() + begin, end - begin, cs);
+			append(tmp);
 			for (auto c : tmp) {
 				res += c;
 				if (c == '\\') // in the ECI protocol a '\' has to be doubled
 					res += c;
 			}
 		} else {
-			TextDecoder::Append(res, bytes.data() + begin, end - begin, cs);
+			append(res);
 		}
 	});
 
@@ -156,9 +163,8 @@ std::string Content::text(TextMode mode) const
 		switch (type()) {
 #ifdef ZXING_READERS
 		case ContentType::GS1: {
-			auto plain = render(false);
-			auto hri = HRIFromGS1(plain);
-			return hri.empty() ? plain : hri;
+			std::vector<GS1Element> elements;
+			return textHRI(elements);
 		}
 		case ContentType::ISO15434: return HRIFromISO15434(render(false));
 		case ContentType::Text: return render(false);
@@ -172,6 +178,28 @@ std::string Content::text(TextMode mode) const
 	return {}; // silence compiler warning
 }
 
+std::string Content::textHRI(std::vector<GS1Element>& gs1Elements) const
+{
+	gs1Elements.clear();
+#ifdef ZXING_READERS
+	if (type() == ContentType::GS1) {
+		auto plain = render(false);
+		auto hri = HRIFromGS1(plain, gs1Elements);
+		// the views point into plain, which is a copy of the bytes unless they are not ASCII (needs a separate pass)
+		auto gs1 = bytes.asString();
+		if (plain != gs1)
+			gs1Elements = GS1Elements(gs1);
+		else
+			for (auto& [ai, value] : gs1Elements) {
+				ai = gs1.substr(ai.data() - plain.data(), ai.size());
+				value = gs1.substr(value.data() - plain.data(), value.size());
+			}
+		return hri.empty() ? plain : hri;
+	}
+#endif
+	return text(TextMode::HRI);
+}
+
 std::wstring Content::utfW() const
 {
 	return FromUtf8(render(false));
@@ -201,7 +229,19 @@ ByteArray Content::bytesECI() const
 
 CharacterSet Content::guessEncoding() const
 {
+	bool isUtf8;
+	return guessEncoding(isUtf8);
+}
+
+CharacterSet Content::guessEncoding(bool& isUtf8) const
+{
+	isUtf8 = false;
 #ifdef ZXING_READERS
+	// the common case of all bytes having an unknown encoding does not need to assemble them
+	if (!hasECI && std::all_of(encodings.begin(), encodings.end(), [](Encoding e) { return e.eci == ECI::Unknown; }))
+		return bytes.empty() ? CharacterSet::Unknown
+							 : TextDecoder::GuessEncoding(bytes.data(), bytes.size(), CharacterSet::ISO8859_1, isUtf8);
+
 	// assemble all blocks with unknown encoding
 	ByteArray input;
 	ForEachECIBlock([&](ECI eci, int begin, int end) {
@@ -212,6 +252,7 @@ CharacterSet Content::guessEncoding() const
 	if (input.empty())
 		return CharacterSet::Unknown;
 
+	// the blocks are interleaved with others, so they are not copied as they are even if they are valid UTF-8 together
 	return TextDecoder::GuessEncoding(input.data(), input.size(), CharacterSet::ISO8859_1);
 #else
 	return CharacterSet::Unknown;
@@ -10,6 +10,7 @@
 #include "ReaderOptions.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ZXing {
@@ -21,6 +22,15 @@ enum class AIFlag : char { None, GS1, AIM };
 
 std::string ToString(ContentType type);
 
+/**
+ * One element string of a GS1 formatted content: the application identifier (AI) and its data field
+ */
+struct GS1Element
+{
+	std::string_view ai;
+	std::string_view value;
+};
+
 struct SymbologyIdentifier
 {
 	char code = 0, modifier = 0, eciModifierOffset = 0;
@@ -39,6 +49,7 @@ class Content
 
 	void switchEncoding(ECI eci, bool isECI);
 	std::string render(bool withECI) const;
+	CharacterSet guessEncoding(bool& isUtf8) const;
 
 public:
 	struct Encoding
@@ -76,6 +87,8 @@ public:
 	bool canProcess() const;
 
 	std::string text(TextMode mode) const;
+	/// text(TextMode::HRI), for GS1 content also the element strings found in the same pass (as views into bytes)
+	std::string textHRI(std::vector<GS1Element>& gs1Elements) const;
 	std::wstring utfW() const; // utf16 or utf32 depending on the platform, i.e. on size_of(wchar_t)
 	std::string utf8() const { return render(false); }
 
@@ -10,7 +10,9 @@
 #include "ZXAlgorithms.h"
 
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <stdexcept>
 #include <string_view>
 
 namespace ZXing {
@@ -33,7 +35,7 @@ struct AiInfo
 };
 
 // https://github.com/gs1/gs1-syntax-dictionary 2023-09-22
-static const AiInfo aiInfos[] = {
+static constexpr AiInfo aiInfos[] = {
 //TWO_DIGIT_DATA_LENGTH
 	{ "00", 18 },
 	{ "01", 14 },
@@ -246,27 +248,78 @@ static const AiInfo aiInfos[] = {
 	{ "8200", -70 },
 };
 
-std::string HRIFromGS1(std::string_view gs1)
+/**
+ * Direct indexed lookup of the aiInfos entry an element string starts with, built at compile time. The AI prefixes are
+ * prefix free, so the first two digits index the root and every further digit a node with 10 slots. A slot is 0 (no
+ * AI), the aiInfos index + 1 or NODE + the index of the node for the next digit.
+ */
+class AiInfoTable
+{
+	static constexpr int NODE = 0x100;
+	static constexpr int MAX_NODES = 48;
+	static_assert(Size(aiInfos) < NODE);
+
+	uint16_t _root[100] = {};
+	uint16_t _nodes[MAX_NODES][10] = {};
+	int _nodeCount = 0;
+
+public:
+	constexpr AiInfoTable()
+	{
+		for (int i = 0; i < Size(aiInfos); ++i) {
+			const char* prefix = aiInfos[i].aiPrefix;
+			uint16_t* slot = &_root[(prefix[0] - '0') * 10 + prefix[1] - '0'];
+			for (int k = 2; prefix[k]; ++k) {
+				if (*slot == 0)
+					*slot = NODE + _nodeCount++; // an index >= MAX_NODES fails to compile
+				else if (*slot < NODE)
+					throw std::logic_error("AI prefixes have to be prefix free");
+				slot = &_nodes[*slot - NODE][prefix[k] - '0'];
+			}
+			if (*slot)
+				throw std::logic_error("AI prefixes have to be prefix free");
+			*slot = i + 1;
+		}
+	}
+
+	const AiInfo* find(std::string_view str) const
+	{
+		auto digit = [&](size_t k) { return k < str.size() && str[k] >= '0' && str[k] <= '9' ? str[k] - '0' : -1; };
+		if (digit(0) < 0 || digit(1) < 0)
+			return nullptr;
+		int slot = _root[digit(0) * 10 + digit(1)];
+		for (size_t k = 2; slot >= NODE; ++k) {
+			if (digit(k) < 0)
+				return nullptr;
+			slot = _nodes[slot - NODE][digit(k)];
+		}
+		return slot ? aiInfos + slot - 1 : nullptr;
+	}
+};
+
+static constexpr AiInfoTable aiInfoTable;
+
+/**
+ * Call f(ai, value) for each element string in gs1 in a single pass and without allocating. Returns false if gs1 is
+ * not a valid sequence of element strings, f may have been called for the elements in front of the error, though.
+ */
+template <typename F>
+static bool ForEachGS1Element(std::string_view gs1, F f)
 {
-	//TODO: c++20
-	auto starts_with = [](std::string_view str, std::string_view pre) { return str.substr(0, pre.size()) == pre; };
 	constexpr char GS = 29; // GS character (29 / 0x1D)
 
 	std::string_view rem = gs1;
-	std::string res;
 
 	while (rem.size()) {
-		const AiInfo* i = FindIf(aiInfos, [&](const AiInfo& i) { return starts_with(rem, i.aiPrefix); });
-		if (i == std::end(aiInfos))
-			return {};
+		const AiInfo* i = aiInfoTable.find(rem);
+		if (!i)
+			return false;
 
 		int aiSize = i->aiSize();
 		if (Size(rem) < aiSize)
-			return {};
+			return false;
 
-		res += '(';
-		res += rem.substr(0, aiSize);
-		res += ')';
+		auto ai = rem.substr(0, aiSize);
 		rem.remove_prefix(aiSize);
 
 		int fieldSize = i->fieldSize();
@@ -280,9 +333,9 @@ std::string HRIFromGS1(std::string_view gs1)
 #endif
 		}
 		if (fieldSize == 0 || Size(rem) < fieldSize)
-			return {};
+			return false;
 
-		res += rem.substr(0, fieldSize);
+		f(ai, rem.substr(0, fieldSize));
 		rem.remove_prefix(fieldSize);
 
 		// See General Specification v22.0 Section 7.8.6.3: "...the processing routine SHALL tolerate a single separator character
@@ -291,6 +344,48 @@ std::string HRIFromGS1(std::string_view gs1)
 			rem.remove_prefix(1);
 	}
 
+	return true;
+}
+
+std::string HRIFromGS1(std::string_view gs1)
+{
+	std::string res;
+	res.reserve(2 * gs1.size()); // every element adds 2 parentheses and is at least 3 characters long
+
+	bool valid = ForEachGS1Element(gs1, [&](std::string_view ai, std::string_view value) {
+		res += '(';
+		res += ai;
+		res += ')';
+		res += value;
+	});
+
+	return valid ? res : std::string();
+}
+
+std::string HRIFromGS1(std::string_view gs1, std::vector<GS1Element>& elements)
+{
+	std::string res;
+	res.reserve(2 * gs1.size());
+	elements.clear();
+
+	bool valid = ForEachGS1Element(gs1, [&](std::string_view ai, std::string_view value) {
+		res += '(';
+		res += ai;
+		res += ')';
+		res += value;
+		elements.push_back({ai, value});
+	});
+
+	if (!valid)
+		elements.clear();
+	return valid ? res : std::string();
+}
+
+std::vector<GS1Element> GS1Elements(std::string_view gs1)
+{
+	std::vector<GS1Element> res;
+	if (!ForEachGS1Element(gs1, [&](std::string_view ai, std::string_view value) { res.push_back({ai, value}); }))
+		res.clear();
 	return res;
 }
 
@@ -5,12 +5,21 @@
 
 #pragma once
 
+#include "Content.h"
+
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace ZXing {
 
 std::string HRIFromGS1(std::string_view gs1);
+
+/// like HRIFromGS1, additionally returns the views of the AIs and values into gs1 found in the same pass
+std::string HRIFromGS1(std::string_view gs1, std::vector<GS1Element>& elements);
+
+/// split the GS1 element string into views of its AIs and values, the result is empty if gs1 is not valid
+std::vector<GS1Element> GS1Elements(std::string_view gs1);
 std::string HRIFromISO15434(std::string_view str);
 
 } // namespace ZXing
@@ -57,9 +57,9 @@ MultiFormatWriter::encode(const std::wstring& contents, int width, int height) c
 
 	switch (_format) {
 	case BarcodeFormat::Aztec: return exec1(Aztec::Writer(), AztecEccLevel);
-	case BarcodeFormat::DataMatrix: return exec2(DataMatrix::Writer());
+	case BarcodeFormat::DataMatrix: return exec2(DataMatrix::Writer().setMinimalEncoding(_dataMatrixMinimalEncoding));
 	case BarcodeFormat::PDF417: return exec1(Pdf417::Writer(), Pdf417EccLevel);
-	case BarcodeFormat::QRCode: return exec1(QRCode::Writer(), QRCodeEccLevel);
+	case BarcodeFormat::QRCode: return exec1(QRCode::Writer().setOptimizeSegments(_optimizeSegments), QRCodeEccLevel);
 	case BarcodeFormat::Codabar: return exec0(OneD::CodabarWriter());
 	case BarcodeFormat::Code39: return exec0(OneD::Code39Writer());
 	case BarcodeFormat::Code93: return exec0(OneD::Code93Writer());
@@ -49,6 +49,22 @@ public:
 		return *this;
 	}
 
+	/**
+	* Used for QRCode only, split the contents into multiple mode segments if that results in a smaller symbol.
+	*/
+	MultiFormatWriter& setOptimizeSegments(bool optimize) {
+		_optimizeSegments = optimize;
+		return *this;
+	}
+
+	/**
+	* Used for DataMatrix only, find the shortest sequence of encodations instead of using the look-ahead heuristic.
+	*/
+	MultiFormatWriter& setDataMatrixMinimalEncoding(bool minimal) {
+		_dataMatrixMinimalEncoding = minimal;
+		return *this;
+	}
+
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 	BitMatrix encode(const std::string& contents, int width, int height) const;
 
@@ -57,6 +73,8 @@ private:
 	CharacterSet _encoding = CharacterSet::Unknown;
 	int _margin = -1;
 	int _eccLevel = -1;
+	bool _optimizeSegments = false;
+	bool _dataMatrixMinimalEncoding = false;
 };
 
 } // ZXing
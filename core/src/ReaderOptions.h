@@ -69,6 +69,7 @@ class ReaderOptions
 
 	uint8_t _minLineCount        = 2;
 	uint8_t _maxNumberOfSymbols  = 0xff;
+	uint8_t _maxThreadCount      = 1;
 	uint16_t _downscaleThreshold = 500;
 	BarcodeFormats _formats      = BarcodeFormat::None;
 
@@ -141,6 +142,10 @@ public:
 	/// The maximum number of symbols (barcodes) to detect / look for in the image with ReadBarcodes
 	ZX_PROPERTY(uint8_t, maxNumberOfSymbols, setMaxNumberOfSymbols)
 
+	/// The maximum number of threads a reader may use to decode a single symbol, default is 1 (currently only used by PDF417)
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint8_t, maxThreadCount, setMaxThreadCount)
+
 	/// Enable the heuristic to detect and decode "full ASCII"/extended Code39 symbols
 	ZX_PROPERTY(bool, tryCode39ExtendedMode, setTryCode39ExtendedMode)
 
@@ -13,12 +13,74 @@
 #include "libzueci/zueci.h"
 
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
 namespace ZXing {
 
+// returns the length of the leading run of ASCII bytes, looking at 32 bytes at a time (auto-vectorized by the compiler)
+static size_t AsciiPrefixLength(const uint8_t* bytes, size_t length)
+{
+	constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32) {
+		uint64_t w[4];
+		std::memcpy(w, bytes + i, sizeof(w));
+		if ((w[0] | w[1] | w[2] | w[3]) & HIGH_BITS)
+			break;
+	}
+	while (i < length && bytes[i] < 0x80)
+		++i;
+	return i;
+}
+
+// the allowed range of the first continuation byte c1 depends on the lead byte c (no overlong forms, no surrogates,
+// nothing above U+10FFFF), see RFC 3629
+static bool IsValidFirstContinuation(uint8_t c, uint8_t c1)
+{
+	const uint8_t lo = c == 0xE0 ? 0xA0 : c == 0xF0 ? 0x90 : 0x80;
+	const uint8_t hi = c == 0xED ? 0x9F : c == 0xF4 ? 0x8F : 0xBF;
+	return c1 >= lo && c1 <= hi;
+}
+
+// strict validation according to RFC 3629, which is exactly what zueci passes through unmodified for ECI 26
+static bool IsValidUtf8(const uint8_t* bytes, size_t length)
+{
+	for (size_t i = 0; (i += AsciiPrefixLength(bytes + i, length - i)) < length;) {
+		const uint8_t c = bytes[i];
+		const int n = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : 1;
+		if (c < 0xC2 || c > 0xF4 || i + n >= length || !IsValidFirstContinuation(c, bytes[i + 1]))
+			return false;
+		for (int j = 2; j <= n; ++j)
+			if ((bytes[i + j] & 0xC0) != 0x80)
+				return false;
+		i += n + 1;
+	}
+	return true;
+}
+
+// whether zueci maps all the ASCII bytes of the given charset to the same code point (with the flags used below)
+static bool IsAsciiCompatible(CharacterSet charset, bool sjisASCII)
+{
+	switch (charset) {
+	case CharacterSet::UTF16BE:
+	case CharacterSet::UTF16LE:
+	case CharacterSet::UTF32BE:
+	case CharacterSet::UTF32LE: return false;
+	case CharacterSet::Shift_JIS: return sjisASCII;
+	default: return true;
+	}
+}
+
 void TextDecoder::Append(std::string& str, const uint8_t* bytes, size_t length, CharacterSet charset, bool sjisASCII)
 {
+	// most content is plain ASCII (or already UTF-8), which can be copied straight through
+	if ((IsAsciiCompatible(charset, sjisASCII) && AsciiPrefixLength(bytes, length) == length)
+		|| (charset == CharacterSet::UTF8 && IsValidUtf8(bytes, length))) {
+		str.append(reinterpret_cast<const char*>(bytes), length);
+		return;
+	}
+
 	int eci = ToInt(ToECI(charset));
 	const size_t str_len = str.length();
 	const int bytes_len = narrow_cast<int>(length);
@@ -29,19 +91,17 @@ void TextDecoder::Append(std::string& str, const uint8_t* bytes, size_t length,
 	if (eci == -1)
 		eci = 899; // Binary
 
-	int error_number = zueci_dest_len_utf8(eci, bytes, bytes_len, replacement, flags, &utf8_len);
-	if (error_number >= ZUECI_ERROR)
-		throw std::runtime_error("zueci_dest_len_utf8 failed");
-
-	str.resize(str_len + utf8_len); // Precise length
+	// convert in a single pass into a buffer of the maximal size (see zueci.h) instead of calling zueci_dest_len_utf8 first
+	str.resize(str_len + 4 * length);
 	unsigned char *utf8_buf = reinterpret_cast<unsigned char *>(str.data()) + str_len;
 
-	error_number = zueci_eci_to_utf8(eci, bytes, bytes_len, replacement, flags, utf8_buf, &utf8_len);
+	int error_number = zueci_eci_to_utf8(eci, bytes, bytes_len, replacement, flags, utf8_buf, &utf8_len);
 	if (error_number >= ZUECI_ERROR) {
 		str.resize(str_len);
 		throw std::runtime_error("zueci_eci_to_utf8 failed");
 	}
-	assert(str.length() == str_len + utf8_len);
+	assert(utf8_len <= narrow_cast<int>(4 * length));
+	str.resize(str_len + utf8_len);
 }
 
 void TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, CharacterSet charset)
@@ -60,12 +120,23 @@ void TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length,
 CharacterSet
 TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fallback)
 {
+	bool isUtf8;
+	return GuessEncoding(bytes, length, fallback, isUtf8);
+}
+
+CharacterSet
+TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fallback, bool& isUtf8)
+{
+	isUtf8 = false;
+
 	// For now, merely tries to distinguish ISO-8859-1, UTF-8 and Shift_JIS,
 	// which should be by far the most common encodings.
 	bool canBeISO88591 = true;
 	bool canBeShiftJIS = true;
 	bool canBeUTF8 = true;
 	int utf8BytesLeft = 0;
+	bool isStrictUTF8 = true; // see IsValidUtf8
+	int utf8Lead = 0; // the lead byte while its first continuation byte is pending
 	//int utf8LowChars = 0;
 	int utf2BytesChars = 0;
 	int utf3BytesChars = 0;
@@ -82,6 +153,13 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 	//int isoHighChars = 0;
 	int isoHighOther = 0;
 
+	// the analysis below always ends up with ISO-8859-1 for pure ASCII, so skip it
+	bool assumeShiftJIS = fallback == CharacterSet::Shift_JIS || fallback == CharacterSet::EUC_JP;
+	if (length > 0 && !assumeShiftJIS && AsciiPrefixLength(bytes, length) == length) {
+		isUtf8 = true;
+		return CharacterSet::ISO8859_1;
+	}
+
 	bool utf8bom = length > 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF;
 
 	for (size_t i = 0; i < length && (canBeISO88591 || canBeShiftJIS || canBeUTF8); ++i)
@@ -96,6 +174,9 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 				}
 				else {
 					utf8BytesLeft--;
+					if ((value & 0x40) != 0 || (utf8Lead && !IsValidFirstContinuation(utf8Lead, value)))
+						isStrictUTF8 = false;
+					utf8Lead = 0;
 				}
 			}
 			else if ((value & 0x80) != 0) {
@@ -103,6 +184,9 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 					canBeUTF8 = false;
 				}
 				else {
+					if (value < 0xC2 || value > 0xF4)
+						isStrictUTF8 = false;
+					utf8Lead = value;
 					utf8BytesLeft++;
 					if ((value & 0x20) == 0) {
 						utf2BytesChars++;
@@ -194,10 +278,10 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 
 	// Easy -- if there is BOM or at least 1 valid not-single byte character (and no evidence it can't be UTF-8), done
 	if (canBeUTF8 && (utf8bom || utf2BytesChars + utf3BytesChars + utf4BytesChars > 0)) {
+		isUtf8 = isStrictUTF8;
 		return CharacterSet::UTF8;
 	}
 
-	bool assumeShiftJIS = fallback == CharacterSet::Shift_JIS || fallback == CharacterSet::EUC_JP;
 	// Easy -- if assuming Shift_JIS or at least 3 valid consecutive not-ascii characters (and no evidence it can't be), done
 	if (canBeShiftJIS && (assumeShiftJIS || sjisMaxKatakanaWordLength >= 3 || sjisMaxDoubleBytesWordLength >= 3)) {
 		return CharacterSet::Shift_JIS;
@@ -220,6 +304,7 @@ TextDecoder::GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fal
 		return CharacterSet::Shift_JIS;
 	}
 	if (canBeUTF8) {
+		isUtf8 = isStrictUTF8;
 		return CharacterSet::UTF8;
 	}
 	// Otherwise, we take a wild guess with platform encoding
@@ -19,6 +19,10 @@ public:
 	static CharacterSet DefaultEncoding();
 	static CharacterSet GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fallback = DefaultEncoding());
 
+	// Like above, `isUtf8` is additionally set if the guess is ISO-8859-1 for pure ASCII or UTF-8 for valid UTF-8 input,
+	// i.e. if the bytes can be appended to a UTF-8 string unchanged without another pass over them (see Append)
+	static CharacterSet GuessEncoding(const uint8_t* bytes, size_t length, CharacterSet fallback, bool& isUtf8);
+
 	// If `sjisASCII` set then for Shift_JIS maps ASCII directly (straight-thru), i.e. does not map ASCII backslash & tilde
 	// to Yen sign & overline resp. (JIS X 0201 Roman)
 	static void Append(std::string& str, const uint8_t* bytes, size_t length, CharacterSet charset, bool sjisASCII = true);
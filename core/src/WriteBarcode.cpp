@@ -7,12 +7,23 @@
 
 #include "WriteBarcode.h"
 #include "BitMatrix.h"
+#include "Scope.h"
 
 #if !defined(ZXING_READERS) && !defined(ZXING_WRITERS)
 #include "Version.h"
 #endif
 
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <ostream>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 #ifdef ZXING_USE_ZINT
 
@@ -31,13 +42,15 @@ struct CreatorOptions::Data
 	BarcodeFormat format;
 	bool readerInit = false;
 	bool forceSquareDataMatrix = false;
+	bool verify = false;
+	int maxThreadCount = 0;
+	bool optimizeSegments = true;
+	bool minimalDataMatrix = false;
 	std::string ecLevel;
 
 	// symbol size (qrcode, datamatrix, etc), map from I, 'WxH'
 	// structured_append (idx, cnt, ID)
 
-	mutable unique_zint_symbol zint;
-
 #if __cplusplus <= 201703L || defined(__APPLE__)
 	Data(BarcodeFormat f) : format(f) {}
 #endif
@@ -51,12 +64,18 @@ struct CreatorOptions::Data
 	ZX_PROPERTY(BarcodeFormat, format)
 	ZX_PROPERTY(bool, readerInit)
 	ZX_PROPERTY(bool, forceSquareDataMatrix)
+	ZX_PROPERTY(bool, verify)
+	ZX_PROPERTY(int, maxThreadCount)
+	ZX_PROPERTY(bool, optimizeSegments)
+	ZX_PROPERTY(bool, minimalDataMatrix)
 	ZX_PROPERTY(std::string, ecLevel)
 
 #undef ZX_PROPERTY
 
 CreatorOptions::CreatorOptions(BarcodeFormat format) : d(std::make_unique<Data>(format)) {}
 CreatorOptions::~CreatorOptions() = default;
+CreatorOptions::CreatorOptions(const CreatorOptions& other) : d(std::make_unique<Data>(*other.d)) {}
+CreatorOptions& CreatorOptions::operator=(const CreatorOptions& other) { return *d = *other.d, *this; }
 CreatorOptions::CreatorOptions(CreatorOptions&&) = default;
 CreatorOptions& CreatorOptions::operator=(CreatorOptions&&) = default;
 
@@ -93,30 +112,6 @@ static bool IsLinearCode(BarcodeFormat format)
 	return BarcodeFormats(BarcodeFormat::LinearCodes).testFlag(format);
 }
 
-static std::string ToSVG(ImageView iv)
-{
-	if (!iv.data())
-		return {};
-
-	// see https://stackoverflow.com/questions/10789059/create-qr-code-in-vector-image/60638350#60638350
-
-	std::ostringstream res;
-
-	res << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
-		<< "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 " << iv.width() << " " << iv.height()
-		<< "\" stroke=\"none\">\n"
-		<< "<path d=\"";
-
-	for (int y = 0; y < iv.height(); ++y)
-		for (int x = 0; x < iv.width(); ++x)
-			if (*iv.data(x, y) == 0)
-				res << "M" << x << "," << y << "h1v1h-1z";
-
-	res << "\"/>\n</svg>";
-
-	return res.str();
-}
-
 static Image ToImage(BitMatrix bits, bool isLinearCode, const WriterOptions& opts)
 {
 	bits.flipAll();
@@ -134,11 +129,119 @@ static Image ToImage(BitMatrix bits, bool isLinearCode, const WriterOptions& opt
 
 #ifdef ZXING_WRITERS
 
-#ifdef ZXING_USE_ZINT
+#include "Content.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
 #include "ECI.h"
+#include "GTIN.h"
+#include "oned/ODUPCEANCommon.h"
+
+#ifdef ZXING_READERS
 #include "ReadBarcode.h"
+#endif
 
-#include <charconv>
+namespace ZXing {
+
+static SymbologyIdentifier DefaultSymbologyIdentifier(BarcodeFormat format, const ByteArray& bytes)
+{
+	// the identifiers the respective readers report for symbols without GS1/AIM flags, see ISO/IEC 15424
+	switch (format) {
+	case BarcodeFormat::Aztec: return {'z', '0', 3};
+	case BarcodeFormat::Codabar: return {'F', '0'};
+	case BarcodeFormat::Code39: return {'A', '0'};
+	case BarcodeFormat::Code93: return {'G', '0'};
+	case BarcodeFormat::Code128: return {'C', '0'};
+	case BarcodeFormat::DataBar: return {'e', '0'};
+	case BarcodeFormat::DataBarExpanded: return {'e', '0', 0, AIFlag::GS1};
+	case BarcodeFormat::DataMatrix: return {'d', '1', 3};
+	case BarcodeFormat::EAN8: return {'E', '4'};
+	case BarcodeFormat::EAN13:
+	case BarcodeFormat::UPCA:
+	case BarcodeFormat::UPCE: return {'E', '0'};
+	case BarcodeFormat::ITF: return {'I', !bytes.empty() && GTIN::IsCheckDigitValid(std::string(bytes.asString())) ? '1' : '0'};
+	case BarcodeFormat::MaxiCode: return {'U', '0', 2};
+	case BarcodeFormat::MicroQRCode:
+	case BarcodeFormat::QRCode:
+	case BarcodeFormat::RMQRCode: return {'Q', '1', 1};
+	case BarcodeFormat::PDF417: return {'L', '2', char(-1)};
+	default: return {};
+	}
+}
+
+// the encoders accept EAN/UPC input without check digit but the symbol (and hence any reader) contains it
+static void AppendCheckDigit(BarcodeFormat format, ByteArray& bytes)
+{
+	auto digits = std::string(bytes.asString());
+	if ((format == BarcodeFormat::EAN8 && digits.size() == 7) || (format == BarcodeFormat::EAN13 && digits.size() == 12)
+		|| (format == BarcodeFormat::UPCA && digits.size() == 11))
+		bytes.push_back(GTIN::ComputeCheckDigit(digits));
+	else if (format == BarcodeFormat::UPCE && digits.size() == 7)
+		bytes.push_back(GTIN::ComputeCheckDigit(OneD::UPCEANCommon::ConvertUPCEtoUPCA(digits)));
+}
+
+/**
+ * The Content of a symbol from the bytes the encoder stored in it, encoded in charset. withECI is set if the encoder
+ * announced charset with an ECI, as the reader then reports it.
+ */
+static Content MakeContent(ByteArray&& bytes, CharacterSet charset, bool withECI, BarcodeFormat format)
+{
+	Content res;
+	withECI ? res.switchEncoding(ToECI(charset)) : res.switchEncoding(charset);
+	res.bytes = std::move(bytes);
+	if (charset != CharacterSet::BINARY)
+		AppendCheckDigit(format, res.bytes);
+	res.symbology = DefaultSymbologyIdentifier(format, res.bytes);
+	return res;
+}
+
+#ifdef ZXING_READERS
+static Barcode ReadBack(const BitMatrix& bits, const CreatorOptions& opts)
+{
+	auto img = ToMatrix<uint8_t>(bits);
+
+	auto res = ReadBarcode({img.data(), img.width(), img.height(), ImageFormat::Lum},
+						   ReaderOptions().setFormats(opts.format()).setIsPure(true).setBinarizer(Binarizer::BoolCast));
+	if (!res.isValid())
+		throw std::runtime_error("Verification of created " + ToString(opts.format()) + " symbol failed");
+	return res;
+}
+#endif
+
+/**
+ * Build the Barcode from the encoder input and the ecLevel and version the encoder reported, with the values the
+ * respective reader would return. With opts.verify() set, the symbol is decoded instead and all meta data (ecLevel,
+ * version, content type, etc.) is taken from the reader.
+ */
+static Barcode MakeBarcode(BitMatrix&& bits, Content&& content, const CreatorOptions& opts, std::string ecLevel, int version)
+{
+	if (opts.verify()) {
+#ifdef ZXING_READERS
+		auto res = ReadBack(bits, opts);
+		res.symbol(std::move(bits));
+		return res;
+#else
+		throw std::invalid_argument("CreatorOptions::verify() requires a build with reader support");
+#endif
+	}
+
+	int left = 0, top = 0, width = bits.width(), height = bits.height();
+	bits.findBoundingBox(left, top, width, height);
+	const int right = left + width - 1, bottom = top + height - 1;
+	auto position = IsLinearCode(opts.format()) ? Line(top + height / 2, left, right)
+												: QuadrilateralI{PointI{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+
+	auto decRes = DecoderResult(std::move(content)).setEcLevel(std::move(ecLevel)).setVersionNumber(version).setReaderInit(opts.readerInit());
+	return Barcode(std::move(decRes), DetectorResult(std::move(bits), std::move(position)), opts.format());
+}
+
+} // namespace ZXing
+
+#ifdef ZXING_USE_ZINT
+#include "TextEncoder.h"
+#include "Utf.h"
+
+#include <algorithm>
+#include <cmath>
 #include <zint.h>
 
 namespace ZXing {
@@ -147,30 +250,39 @@ struct BarcodeFormatZXing2Zint
 {
 	BarcodeFormat zxing;
 	int zint;
+	int quietZoneX, quietZoneY; // in modules, as added by zint with BARCODE_QUIET_ZONES
 };
 
 static constexpr BarcodeFormatZXing2Zint barcodeFormatZXing2Zint[] = {
-	{BarcodeFormat::Aztec, BARCODE_AZTEC},
-	{BarcodeFormat::Codabar, BARCODE_CODABAR},
-	{BarcodeFormat::Code39, BARCODE_CODE39},
-	{BarcodeFormat::Code93, BARCODE_CODE93},
-	{BarcodeFormat::Code128, BARCODE_CODE128},
-	{BarcodeFormat::DataBar, BARCODE_DBAR_OMN},
-	{BarcodeFormat::DataBarExpanded, BARCODE_DBAR_EXP},
-	{BarcodeFormat::DataMatrix, BARCODE_DATAMATRIX},
-	{BarcodeFormat::DXFilmEdge, -1},
-	{BarcodeFormat::EAN8, BARCODE_EANX},
-	{BarcodeFormat::EAN13, BARCODE_EANX},
-	{BarcodeFormat::ITF, BARCODE_C25INTER},
-	{BarcodeFormat::MaxiCode, BARCODE_MAXICODE},
-	{BarcodeFormat::MicroQRCode, BARCODE_MICROQR},
-	{BarcodeFormat::PDF417, BARCODE_PDF417},
-	{BarcodeFormat::QRCode, BARCODE_QRCODE},
-	{BarcodeFormat::RMQRCode, BARCODE_RMQR},
-	{BarcodeFormat::UPCA, BARCODE_UPCA},
-	{BarcodeFormat::UPCE, BARCODE_UPCE},
+	{BarcodeFormat::Aztec, BARCODE_AZTEC, 0, 0},
+	{BarcodeFormat::Codabar, BARCODE_CODABAR, 10, 0},
+	{BarcodeFormat::Code39, BARCODE_CODE39, 10, 0},
+	{BarcodeFormat::Code93, BARCODE_CODE93, 10, 0},
+	{BarcodeFormat::Code128, BARCODE_CODE128, 10, 0},
+	{BarcodeFormat::DataBar, BARCODE_DBAR_OMN, 1, 0},
+	{BarcodeFormat::DataBarExpanded, BARCODE_DBAR_EXP, 1, 0},
+	{BarcodeFormat::DataMatrix, BARCODE_DATAMATRIX, 1, 1},
+	{BarcodeFormat::DXFilmEdge, -1, 0, 0},
+	{BarcodeFormat::EAN8, BARCODE_EANX, 7, 0},
+	{BarcodeFormat::EAN13, BARCODE_EANX, 11, 0},
+	{BarcodeFormat::ITF, BARCODE_C25INTER, 10, 0},
+	{BarcodeFormat::MaxiCode, BARCODE_MAXICODE, 0, 0}, // rasterized by zint, see ModuleMatrix
+	{BarcodeFormat::MicroQRCode, BARCODE_MICROQR, 2, 2},
+	{BarcodeFormat::PDF417, BARCODE_PDF417, 2, 2},
+	{BarcodeFormat::QRCode, BARCODE_QRCODE, 4, 4},
+	{BarcodeFormat::RMQRCode, BARCODE_RMQR, 2, 2},
+	{BarcodeFormat::UPCA, BARCODE_UPCA, 9, 0},
+	{BarcodeFormat::UPCE, BARCODE_UPCE, 9, 0},
 };
 
+static const BarcodeFormatZXing2Zint& FindZintFormat(BarcodeFormat format)
+{
+	auto i = FindIf(barcodeFormatZXing2Zint, [format](auto& v) { return v.zxing == format; });
+	if (i == std::end(barcodeFormatZXing2Zint) || i->zint == -1)
+		throw std::invalid_argument("unsupported barcode format: " + ToString(format));
+	return *i;
+}
+
 struct String2Int
 {
 	const char* str;
@@ -217,26 +329,66 @@ static int ParseECLevel(int symbology, std::string_view s)
 	return res;
 };
 
-zint_symbol* CreatorOptions::zint() const
+/**
+ * The ecLevel the respective reader reports for the encoded symbol. After encoding, zint returns the level it actually
+ * used in option_1 (for QR Code style symbols shifted by 8 bits, 1-4 meaning L-H).
+ */
+static std::string ECLevelZint2ZXing(const zint_symbol* zint)
 {
-	auto& zint = d->zint;
+	constexpr char EC_LABELS_QR[4] = {'L', 'M', 'Q', 'H'};
+
+	switch (zint->symbology) {
+	case BARCODE_QRCODE:
+	case BARCODE_MICROQR:
+	case BARCODE_RMQR:
+		if (int level = (zint->option_1 >> 8) & 0xff; level >= 1 && level <= 4)
+			return {EC_LABELS_QR[level - 1]};
+		break;
+	case BARCODE_PDF417:
+		// the reader reports the percentage of error correction codewords, option_2 returns the number of columns
+		if (zint->option_1 >= 0 && zint->option_1 <= 8 && zint->option_2 > 0 && zint->rows > 0)
+			return std::to_string((2 << zint->option_1) * 100 / (zint->option_2 * zint->rows)) + "%";
+		break;
+	default: break;
+	}
+	return {};
+}
 
-	if (!zint) {
-#ifdef PRINT_DEBUG
-		printf("zint version: %d, sizeof(zint_symbol): %ld\n", ZBarcode_Version(), sizeof(zint_symbol));
-#endif
-		zint.reset(ZBarcode_Create());
+/**
+ * The version the respective reader reports for the encoded symbol, zint returns the size it actually used in option_2.
+ */
+static int VersionZint2ZXing(const zint_symbol* zint)
+{
+	switch (zint->symbology) {
+	case BARCODE_QRCODE:
+	case BARCODE_MICROQR:
+	case BARCODE_RMQR:
+	case BARCODE_DATAMATRIX: return zint->option_2;
+	case BARCODE_AZTEC: return zint->option_2 > 4 ? zint->option_2 - 4 : zint->option_2; // the number of layers
+	default: return 0;
+	}
+}
 
-		auto i = FindIf(barcodeFormatZXing2Zint, [zxing = format()](auto& v) { return v.zxing == zxing; });
-		if (i == std::end(barcodeFormatZXing2Zint))
-			throw std::invalid_argument("unsupported barcode format: " + ToString(format()));
-		zint->symbology = i->zint;
+static void SetCreatorOptions(zint_symbol* zint, const CreatorOptions& opts)
+{
+	zint->symbology = FindZintFormat(opts.format()).zint;
 
-		zint->scale = 0.5f;
+	zint->scale = 0.5f;
 
-		if (!ecLevel().empty())
-			zint->option_1 = ParseECLevel(zint->symbology, ecLevel());
-	}
+	if (!opts.ecLevel().empty())
+		zint->option_1 = ParseECLevel(zint->symbology, opts.ecLevel());
+}
+
+/**
+ * A zint_symbol owned by the calling thread, reset and set up for opts. It is used whenever the resulting Barcode
+ * does not need to keep the zint_symbol (see CreateBarcodesFromText), so bulk encoding does not allocate one per symbol.
+ */
+static zint_symbol* ThreadLocalZintSymbol(const CreatorOptions& opts)
+{
+	thread_local unique_zint_symbol zint(ZBarcode_Create());
+
+	ZBarcode_Reset(zint.get());
+	SetCreatorOptions(zint.get(), opts);
 
 	return zint.get();
 }
@@ -245,43 +397,117 @@ zint_symbol* CreatorOptions::zint() const
 	if (int err = (ZINT_CALL); err) \
 		throw std::invalid_argument(zint->errtxt);
 
-Barcode CreateBarcode(const void* data, int size, int mode, const CreatorOptions& opts)
+/**
+ * Let zint rasterize the symbol into its intermediate bitmap ('1' for dark pixels) with the quiet zones added.
+ */
+static BitMatrix ZintRaster(zint_symbol* zint)
 {
-	auto zint = opts.zint();
-
-	zint->input_mode = mode;
+	const int outputOptions = zint->output_options;
+	SCOPE_EXIT([&] { zint->output_options = outputOptions; });
 	zint->output_options |= OUT_BUFFER_INTERMEDIATE | BARCODE_QUIET_ZONES;
 
+	CHECK(ZBarcode_Buffer(zint, 0));
+
+	auto bits = BitMatrix(zint->bitmap_width, zint->bitmap_height);
+	std::transform(zint->bitmap, zint->bitmap + zint->bitmap_width * zint->bitmap_height, bits.row(0).begin(),
+				   [](unsigned char v) { return (v == '1') * BitMatrix::SET_V; });
+	return bits;
+}
+
+/**
+ * Build the module matrix straight from zint's encoded_data (one bit per module, see module_is_set() in zint's
+ * common.c) instead of rasterizing the symbol. Rows are repeated according to their height in modules, so linear and
+ * stacked codes keep their bar height, and the quiet zones are added around it.
+ */
+static BitMatrix ModuleMatrix(zint_symbol* zint, BarcodeFormat format)
+{
+	// the MaxiCode module grid (odd rows shifted by half a module, no bullseye) is not an image of the symbol
+	if (zint->symbology == BARCODE_MAXICODE)
+		return ZintRaster(zint);
+
+	const int qzX = FindZintFormat(format).quietZoneX, qzY = FindZintFormat(format).quietZoneY;
+
+	int height = 2 * qzY;
+	for (int y = 0; y < zint->rows; ++y)
+		height += std::max(1, int(std::lround(zint->row_height[y])));
+
+	auto bits = BitMatrix(zint->width + 2 * qzX, height);
+	for (int y = 0, by = qzY; y < zint->rows; ++y) {
+		const auto* row = zint->encoded_data[y];
+		const int rowHeight = std::max(1, int(std::lround(zint->row_height[y])));
+		for (int x = 0; x < zint->width; ++x)
+			if ((row[x >> 3] >> (x & 7)) & 1)
+				bits.set(qzX + x, by);
+		for (int i = 1; i < rowHeight; ++i)
+			std::copy(bits.row(by).begin(), bits.row(by).end(), bits.row(by + i).begin());
+		by += rowHeight;
+	}
+	return bits;
+}
+
+/**
+ * The bytes zint stores in the symbol: binary data as is, text converted from UTF-8 to the character set of the ECI or,
+ * without ECI, to ISO-8859-1. For text that is not Latin-1 zint picks another character set (e.g. Shift_JIS in QRCode)
+ * or an ECI on its own without reporting it back, the UTF-8 input is kept in that case.
+ */
+static Content ZintContent(const zint_symbol* zint, const void* data, int size, int mode, BarcodeFormat format)
+{
+	auto input = std::string(static_cast<const char*>(data), size);
+	if (mode == DATA_MODE)
+		return MakeContent(ByteArray(input), CharacterSet::BINARY, zint->eci == static_cast<int>(ECI::Binary), format);
+	if (zint->eci > 0) {
+		auto charset = ToCharacterSet(ECI(zint->eci));
+		return MakeContent(ByteArray(TextEncoder::FromUnicode(input, charset)), charset, true, format);
+	}
+	auto text = FromUtf8(input);
+	if (std::all_of(text.begin(), text.end(), [](wchar_t c) { return c < 0x100; }))
+		return MakeContent(ByteArray(TextEncoder::FromUnicode(text, CharacterSet::ISO8859_1)), CharacterSet::ISO8859_1, false, format);
+	return MakeContent(ByteArray(input), CharacterSet::UTF8, false, format);
+}
+
+static Barcode Encode(zint_symbol* zint, const void* data, int size, int mode, const CreatorOptions& opts)
+{
+	zint->input_mode = mode | (opts.optimizeSegments() ? 0 : FAST_MODE);
+
 	if (mode == DATA_MODE && ZBarcode_Cap(zint->symbology, ZINT_CAP_ECI))
 		zint->eci = static_cast<int>(ECI::Binary);
 
-	CHECK(ZBarcode_Encode_and_Buffer(zint, (uint8_t*)data, size, 0));
+	CHECK(ZBarcode_Encode(zint, (uint8_t*)data, size));
 
 #ifdef PRINT_DEBUG
 	printf("create symbol with size: %dx%d\n", zint->width, zint->rows);
 #endif
 
-#ifdef ZXING_READERS
-	auto buffer = std::vector<uint8_t>(zint->bitmap_width * zint->bitmap_height);
-	std::transform(zint->bitmap, zint->bitmap + zint->bitmap_width * zint->bitmap_height, buffer.data(),
-				   [](unsigned char v) { return (v == '0') * 0xff; });
+	auto bits = ModuleMatrix(zint, opts.format());
 
-	auto res = ReadBarcode({buffer.data(), zint->bitmap_width, zint->bitmap_height, ImageFormat::Lum},
-						   ReaderOptions().setFormats(opts.format()).setIsPure(true).setBinarizer(Binarizer::BoolCast));
-#else
-	//TODO: replace by proper construction from encoded data from within zint
-	auto res = Barcode(std::string((const char*)data, size), 0, 0, 0, opts.format(), {});
+	auto content = ZintContent(zint, data, size, mode, opts.format());
+	return MakeBarcode(std::move(bits), std::move(content), opts, ECLevelZint2ZXing(zint), VersionZint2ZXing(zint));
+}
+
+static Barcode CreateBarcode(const void* data, int size, int mode, const CreatorOptions& opts)
+{
+#ifdef PRINT_DEBUG
+	printf("zint version: %d, sizeof(zint_symbol): %ld\n", ZBarcode_Version(), sizeof(zint_symbol));
 #endif
+	// the Barcode keeps its own zint_symbol for rendering via WriteBarcodeToSVG/Image
+	auto zint = unique_zint_symbol(ZBarcode_Create());
+	SetCreatorOptions(zint.get(), opts);
 
-	auto bits = BitMatrix(zint->bitmap_width, zint->bitmap_height);
-	std::transform(zint->bitmap, zint->bitmap + zint->bitmap_width * zint->bitmap_height, bits.row(0).begin(),
-				   [](unsigned char v) { return (v == '1') * BitMatrix::SET_V; });
-	res.symbol(std::move(bits));
-	res.zint(std::move(opts.d->zint));
+	auto res = Encode(zint.get(), data, size, mode, opts);
+	res.zint(std::move(zint));
 
 	return res;
 }
 
+static Barcode CreateBatchBarcode(std::string_view contents, const CreatorOptions& opts)
+{
+	// MaxiCode's hexagons and the human readable text of linear codes can only be rendered via the zint_symbol
+	if (opts.format() == BarcodeFormat::MaxiCode || IsLinearCode(opts.format()))
+		return CreateBarcode(contents.data(), Size(contents), UNICODE_MODE, opts);
+
+	return Encode(ThreadLocalZintSymbol(opts), contents.data(), Size(contents), UNICODE_MODE, opts);
+}
+
 Barcode CreateBarcodeFromText(std::string_view contents, const CreatorOptions& opts)
 {
 	return CreateBarcode(contents.data(), contents.size(), UNICODE_MODE, opts);
@@ -301,57 +527,160 @@ Barcode CreateBarcodeFromBytes(const void* data, int size, const CreatorOptions&
 
 // Writer ========================================================================
 
-struct SetCommonWriterOptions
+/**
+ * Rendering leaves the zint_symbol of the (const) Barcode untouched, so one Barcode can be rendered concurrently at
+ * different sizes. The encoded symbol is copied into a fresh zint_symbol instead, which receives the writer options and
+ * owns the output buffers. Only the input fields and the encoded result (plain values and arrays) are copied, never a
+ * pointer, so a zint_symbol member added by a later zint version can not end up being freed twice.
+ */
+static unique_zint_symbol RenderSymbol(const zint_symbol* encoded, const WriterOptions& opts)
 {
-	zint_symbol* zint;
-
-	SetCommonWriterOptions(zint_symbol* zint, const WriterOptions& opts) : zint(zint)
-	{
-		zint->show_hrt = opts.withHRT();
-
-		zint->output_options &= ~OUT_BUFFER_INTERMEDIATE;
-		zint->output_options |= opts.withQuietZones() ? BARCODE_QUIET_ZONES : BARCODE_NO_QUIET_ZONES;
-
-		if (opts.scale())
-			zint->scale = opts.scale() / 2.f;
-		else if (opts.sizeHint()) {
-			int size = std::max(zint->width, zint->rows);
-			zint->scale = std::max(1, int(float(opts.sizeHint()) / size)) / 2.f;
-		}
+	auto zint = unique_zint_symbol(ZBarcode_Create());
+
+	// the input fields, see section 5.6 'Setting Options' of the zint manual
+	zint->symbology = encoded->symbology;
+	zint->height = encoded->height;
+	zint->scale = encoded->scale;
+	zint->whitespace_width = encoded->whitespace_width;
+	zint->whitespace_height = encoded->whitespace_height;
+	zint->border_width = encoded->border_width;
+	zint->output_options = encoded->output_options;
+	std::memcpy(zint->fgcolour, encoded->fgcolour, sizeof(zint->fgcolour));
+	std::memcpy(zint->bgcolour, encoded->bgcolour, sizeof(zint->bgcolour));
+	std::memcpy(zint->primary, encoded->primary, sizeof(zint->primary));
+	zint->option_1 = encoded->option_1;
+	zint->option_2 = encoded->option_2;
+	zint->option_3 = encoded->option_3;
+	zint->input_mode = encoded->input_mode;
+	zint->eci = encoded->eci;
+	zint->dpmm = encoded->dpmm;
+	zint->dot_size = encoded->dot_size;
+	zint->text_gap = encoded->text_gap;
+	zint->guard_descent = encoded->guard_descent;
+	zint->structapp = encoded->structapp;
+	zint->warn_level = encoded->warn_level;
+
+	// the result of ZBarcode_Encode
+	zint->rows = encoded->rows;
+	zint->width = encoded->width;
+	std::memcpy(zint->text, encoded->text, sizeof(zint->text));
+	std::memcpy(zint->encoded_data, encoded->encoded_data, encoded->rows * sizeof(zint->encoded_data[0]));
+	std::memcpy(zint->row_height, encoded->row_height, encoded->rows * sizeof(zint->row_height[0]));
+
+	zint->show_hrt = opts.withHRT();
+
+	zint->output_options |= opts.withQuietZones() ? BARCODE_QUIET_ZONES : BARCODE_NO_QUIET_ZONES;
+
+	if (opts.scale())
+		zint->scale = opts.scale() / 2.f;
+	else if (opts.sizeHint()) {
+		int size = std::max(zint->width, zint->rows);
+		zint->scale = std::max(1, int(float(opts.sizeHint()) / size)) / 2.f;
 	}
 
-	// reset the defaults such that consecutive write calls don't influence each other
-	~SetCommonWriterOptions() { zint->scale = 0.5f; }
-};
+	return zint;
+}
 
 } // ZXing
 
 #else // ZXING_USE_ZINT
 
 #include "MultiFormatWriter.h"
-#include "ReadBarcode.h"
+#include "TextEncoder.h"
+#include "Utf.h"
+#include "ZXAlgorithms.h"
+#include "aztec/AZEncoder.h"
+#include "pdf417/PDFEncoder.h"
+#include "qrcode/QREncodeResult.h"
+#include "qrcode/QREncoder.h"
+#include "qrcode/QRErrorCorrectionLevel.h"
 
 namespace ZXing {
 
-zint_symbol* CreatorOptions::zint() const { return nullptr; }
+// the version the DataMatrix reader reports: the index of the symbol size in ISO/IEC 16022 Table 7
+static int DataMatrixVersion(int width, int height)
+{
+	constexpr PointI SIZES[] = {{10, 10},   {12, 12},   {14, 14},   {16, 16},   {18, 18},   {20, 20},  {22, 22},
+								{24, 24},   {26, 26},   {32, 32},   {36, 36},   {40, 40},   {44, 44},  {48, 48},
+								{52, 52},   {64, 64},   {72, 72},   {80, 80},   {88, 88},   {96, 96},  {104, 104},
+								{120, 120}, {132, 132}, {144, 144}, {18, 8},    {32, 8},    {26, 12},  {36, 12},
+								{36, 16},   {48, 16}};
+	return IndexOf(SIZES, PointI{width, height}) + 1;
+}
 
-static Barcode CreateBarcode(BitMatrix&& bits, const CreatorOptions& opts)
+// the ecLevel the PDF417 reader reports: the percentage of error correction codewords
+static std::string Pdf417ECLevel(const Pdf417::BarcodeMatrix& logic, int ecLevel)
 {
-	auto img = ToMatrix<uint8_t>(bits);
+	return std::to_string((2 << ecLevel) * 100 / (logic.rows() * logic.columns())) + "%";
+}
 
-	auto res = ReadBarcode({img.data(), img.width(), img.height(), ImageFormat::Lum},
-						   ReaderOptions().setFormats(opts.format()).setIsPure(true).setBinarizer(Binarizer::BoolCast));
-	res.symbol(std::move(bits));
+// each row is drawn 4 modules high, like Pdf417::Writer does
+static BitMatrix Pdf417Matrix(Pdf417::BarcodeMatrix& logic)
+{
+	std::vector<std::vector<bool>> rows;
+	logic.getScaledMatrix(1, 4, rows); // bottom row first
+	BitMatrix res(Size(rows.front()), Size(rows));
+	for (int y = 0; y < res.height(); ++y)
+		for (int x = 0; x < res.width(); ++x)
+			if (rows[res.height() - 1 - y][x])
+				res.set(x, y);
 	return res;
 }
 
-Barcode CreateBarcodeFromText(std::string_view contents, const CreatorOptions& opts)
+/**
+ * QRCode, Aztec and PDF417 symbols are created with their Encoder directly (instead of via MultiFormatWriter), since only
+ * the Encoder knows the ecLevel and version resp. number of layers or rows and columns of the symbol.
+ */
+static Barcode CreateBarcode(const std::wstring& contents, CharacterSet encoding, const CreatorOptions& opts)
 {
-	auto writer = MultiFormatWriter(opts.format()).setMargin(0);
-	if (!opts.ecLevel().empty())
-		writer.setEccLevel(std::stoi(opts.ecLevel()));
+	const int ecLevel = opts.ecLevel().empty() ? -1 : std::stoi(opts.ecLevel()); // [0-8], see MultiFormatWriter
+	const bool hasECLevel = ecLevel >= 0 && ecLevel <= 8;
+
+	// all encoders store the text converted with TextEncoder::FromUnicode, ISO-8859-1 being their default character set
+	const auto charset = encoding == CharacterSet::Unknown ? CharacterSet::ISO8859_1 : encoding;
+	auto content = [&](bool withECI) {
+		return MakeContent(ByteArray(TextEncoder::FromUnicode(contents, charset)), charset, withECI, opts.format());
+	};
+
+	switch (opts.format()) {
+	case BarcodeFormat::QRCode: {
+		auto level = hasECLevel ? static_cast<QRCode::ErrorCorrectionLevel>((ecLevel - 1) / 2) : QRCode::ErrorCorrectionLevel::Low;
+		auto qr = QRCode::Encode(contents, level, encoding, 0, false, -1, opts.optimizeSegments());
+		return MakeBarcode(std::move(qr.matrix), content(qr.eci != ECI::Unknown), opts, ToString(qr.ecLevel),
+						   qr.version->versionNumber());
+	}
+	case BarcodeFormat::Aztec: {
+		auto aztec = Aztec::Encoder::Encode(TextEncoder::FromUnicode(contents, charset),
+											hasECLevel ? ecLevel * 100 / 8 : Aztec::Encoder::DEFAULT_EC_PERCENT,
+											Aztec::Encoder::DEFAULT_AZTEC_LAYERS);
+		return MakeBarcode(std::move(aztec.matrix), content(false), opts, {}, aztec.layers);
+	}
+	case BarcodeFormat::PDF417: {
+		Pdf417::Encoder encoder;
+		encoder.setEncoding(charset);
+		const int level = hasECLevel ? ecLevel : Pdf417::Encoder::DEFAULT_ERROR_CORRECTION_LEVEL;
+		auto logic = encoder.generateBarcodeLogic(contents, level);
+		// Pdf417::HighLevelEncoder announces any character set but ISO-8859-1 with an ECI
+		return MakeBarcode(Pdf417Matrix(logic), content(charset != CharacterSet::ISO8859_1), opts, Pdf417ECLevel(logic, level), 0);
+	}
+	default: break;
+	}
 
-	return CreateBarcode(writer.encode(std::string(contents), 0, IsLinearCode(opts.format()) ? 50 : 0), opts);
+	auto writer = MultiFormatWriter(opts.format())
+					  .setMargin(0)
+					  .setOptimizeSegments(opts.optimizeSegments())
+					  .setDataMatrixMinimalEncoding(opts.minimalDataMatrix())
+					  .setEccLevel(ecLevel)
+					  .setEncoding(encoding);
+	auto bits = writer.encode(contents, 0, IsLinearCode(opts.format()) ? 50 : 0);
+
+	int version = opts.format() == BarcodeFormat::DataMatrix ? DataMatrixVersion(bits.width(), bits.height()) : 0;
+	return MakeBarcode(std::move(bits), content(false), opts, {}, version);
+}
+
+Barcode CreateBarcodeFromText(std::string_view contents, const CreatorOptions& opts)
+{
+	return CreateBarcode(FromUtf8(contents), CharacterSet::Unknown, opts);
 }
 
 #if __cplusplus > 201703L
@@ -367,29 +696,75 @@ Barcode CreateBarcodeFromBytes(const void* data, int size, const CreatorOptions&
 	for (uint8_t c : std::basic_string_view<uint8_t>((uint8_t*)data, size))
 		bytes.push_back(c);
 
-	auto writer = MultiFormatWriter(opts.format()).setMargin(0);
-	if (!opts.ecLevel().empty())
-		writer.setEccLevel(std::stoi(opts.ecLevel()));
-	writer.setEncoding(CharacterSet::BINARY);
+	return CreateBarcode(bytes, CharacterSet::BINARY, opts);
+}
 
-	return CreateBarcode(writer.encode(bytes, 0, IsLinearCode(opts.format()) ? 50 : 0), opts);
+static Barcode CreateBatchBarcode(std::string_view contents, const CreatorOptions& opts)
+{
+	return CreateBarcodeFromText(contents, opts);
 }
 
 } // namespace ZXing
 
 #endif // ZXING_USE_ZINT
 
+namespace ZXing {
+
+Barcodes CreateBarcodesFromText(const std::string_view* contents, int count, const CreatorOptions& opts)
+{
+	Barcodes res(count);
+	std::atomic<int> next = 0;
+	std::exception_ptr error;
+	std::mutex errorMutex;
+
+	auto worker = [&] {
+		for (int i; (i = next++) < count;) {
+			try {
+				res[i] = CreateBatchBarcode(contents[i], opts);
+			} catch (...) {
+				std::lock_guard lock(errorMutex);
+				if (!error)
+					error = std::current_exception();
+				next = count;
+			}
+		}
+	};
+
+	int threadCount = opts.maxThreadCount() > 0 ? opts.maxThreadCount() : std::thread::hardware_concurrency();
+	{
+		std::vector<std::thread> threads;
+		// the workers reference the locals above, join them even if starting one of them throws
+		SCOPE_EXIT([&] {
+			for (auto& thread : threads)
+				thread.join();
+		});
+		for (int i = 1; i < std::min(threadCount, count); ++i)
+			threads.emplace_back(worker);
+		worker();
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+
+	return res;
+}
+
+} // namespace ZXing
+
 #else // ZXING_WRITERS
 
 namespace ZXing {
 
-zint_symbol* CreatorOptions::zint() const { return nullptr; }
-
 Barcode CreateBarcodeFromText(std::string_view, const CreatorOptions&)
 {
 	throw std::runtime_error("This build of zxing-cpp does not support creating barcodes.");
 }
 
+Barcodes CreateBarcodesFromText(const std::string_view*, int, const CreatorOptions&)
+{
+	throw std::runtime_error("This build of zxing-cpp does not support creating barcodes.");
+}
+
 #if __cplusplus > 201703L
 Barcode CreateBarcodeFromText(std::u8string_view, const CreatorOptions&)
 {
@@ -408,38 +783,296 @@ Barcode CreateBarcodeFromBytes(const void*, int, const CreatorOptions&)
 
 namespace ZXing {
 
-std::string WriteBarcodeToSVG(const Barcode& barcode, [[maybe_unused]] const WriterOptions& opts)
+struct BarcodeCache::Data
+{
+	using Entry = std::pair<std::string, std::shared_ptr<const Barcode>>;
+
+	int capacity;
+	std::list<Entry> lru; // most recently used first
+	std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // keys point into the entries of lru
+	std::mutex mutex;
+	int64_t hits = 0;
+	int64_t misses = 0;
+
+	template <typename CREATE>
+	std::shared_ptr<const Barcode> lookupOrCreate(std::string&& key, CREATE create)
+	{
+		{
+			std::lock_guard lock(mutex);
+			if (auto i = index.find(key); i != index.end()) {
+				++hits;
+				lru.splice(lru.begin(), lru, i->second);
+				return i->second->second;
+			}
+			++misses;
+		}
+
+		// create without holding the lock, so a miss does not block the lookups of other threads
+		auto barcode = std::make_shared<const Barcode>(create());
+
+		std::lock_guard lock(mutex);
+		if (auto i = index.find(key); i != index.end()) // created concurrently by another thread
+			return i->second->second;
+		if (capacity > 0) {
+			lru.emplace_front(std::move(key), barcode);
+			index.emplace(lru.front().first, lru.begin());
+			if (Size(lru) > capacity) {
+				index.erase(lru.back().first);
+				lru.pop_back();
+			}
+		}
+		return barcode;
+	}
+};
+
+/**
+ * The full content plus every option that influences the created Barcode (not maxThreadCount). Storing the content
+ * instead of only its hash means a hash collision can not return the wrong symbol.
+ */
+static std::string CacheKey(const CreatorOptions& opts, bool isBinary, const void* data, int size)
+{
+	std::string key = ToString(opts.format()) + '\0' + opts.ecLevel() + '\0';
+	for (bool flag : {isBinary, opts.readerInit(), opts.forceSquareDataMatrix(), opts.verify(), opts.optimizeSegments(),
+					  opts.minimalDataMatrix()})
+		key.push_back('0' + flag);
+	key.append(static_cast<const char*>(data), size);
+	return key;
+}
+
+BarcodeCache::BarcodeCache(int capacity) : d(std::make_unique<Data>())
+{
+	d->capacity = capacity;
+}
+
+BarcodeCache::~BarcodeCache() = default;
+
+std::shared_ptr<const Barcode> BarcodeCache::createFromText(std::string_view contents, const CreatorOptions& opts)
+{
+	return d->lookupOrCreate(CacheKey(opts, false, contents.data(), Size(contents)),
+							 [&] { return CreateBarcodeFromText(contents, opts); });
+}
+
+std::shared_ptr<const Barcode> BarcodeCache::createFromBytes(const void* data, int size, const CreatorOptions& opts)
+{
+	return d->lookupOrCreate(CacheKey(opts, true, data, size), [&] { return CreateBarcodeFromBytes(data, size, opts); });
+}
+
+int BarcodeCache::capacity() const noexcept
+{
+	return d->capacity;
+}
+
+int BarcodeCache::size() const
+{
+	std::lock_guard lock(d->mutex);
+	return Size(d->lru);
+}
+
+int64_t BarcodeCache::hits() const
+{
+	std::lock_guard lock(d->mutex);
+	return d->hits;
+}
+
+int64_t BarcodeCache::misses() const
+{
+	std::lock_guard lock(d->mutex);
+	return d->misses;
+}
+
+void BarcodeCache::clear()
+{
+	std::lock_guard lock(d->mutex);
+	d->index.clear();
+	d->lru.clear();
+}
+
+} // namespace ZXing
+
+namespace ZXing {
+
+/**
+ * The part of the module matrix to render: all of it or only the bounding box of the dark modules (without quiet
+ * zones), rotated clockwise by opts.rotate(). Dark modules are 0, see Barcode::symbol().
+ */
+static ImageView SymbolArea(const Barcode& barcode, const WriterOptions& opts)
+{
+	auto symbol = barcode.symbol();
+	if (!symbol.data())
+		return {};
+
+	const int rotate = (opts.rotate() % 360 + 360) % 360;
+	if (rotate % 90)
+		throw std::invalid_argument("Only rotations by multiples of 90 degrees are supported");
+
+	int x0 = 0, y0 = 0, x1 = symbol.width(), y1 = symbol.height();
+	if (!opts.withQuietZones()) {
+		auto isDark = [&](int x, int y) { return *symbol.data(x, y) == 0; };
+		auto isEmptyRow = [&](int y) { for (int x = x0; x < x1; ++x) if (isDark(x, y)) return false; return true; };
+		auto isEmptyCol = [&](int x) { for (int y = y0; y < y1; ++y) if (isDark(x, y)) return false; return true; };
+		while (y0 < y1 && isEmptyRow(y0)) ++y0;
+		while (y1 > y0 && isEmptyRow(y1 - 1)) --y1;
+		while (x0 < x1 && isEmptyCol(x0)) ++x0;
+		while (x1 > x0 && isEmptyCol(x1 - 1)) --x1;
+		if (x0 == x1)
+			return {};
+	}
+
+	return symbol.cropped(x0, y0, x1 - x0, y1 - y0).rotated(rotate);
+}
+
+// pixels per module: options.scale() or the largest integer scale fitting into options.sizeHint(), 0 if neither is set
+static int ModuleScale(const ImageView& area, const WriterOptions& opts)
+{
+	if (opts.scale() > 0)
+		return opts.scale();
+	return opts.sizeHint() > 0 ? std::max(1, opts.sizeHint() / std::max(area.width(), area.height())) : 0;
+}
+
+// call f(x, y, length) for each horizontal run of dark modules
+template <typename F>
+static void ForEachDarkRun(const ImageView& area, F f)
+{
+	for (int y = 0; y < area.height(); ++y)
+		for (int x = 0; x < area.width();) {
+			int end = x + 1;
+			while (end < area.width() && *area.data(end, y) == *area.data(x, y))
+				++end;
+			if (*area.data(x, y) == 0)
+				f(x, y, end - x);
+			x = end;
+		}
+}
+
+static void WriteSVG(const ImageView& area, std::ostream& out, int scale)
+{
+	// see https://stackoverflow.com/questions/10789059/create-qr-code-in-vector-image/60638350#60638350
+
+	char buf[64];
+	auto putRun = [&](int dx, int dy, int len) {
+		char* p = buf;
+		*p++ = 'm';
+		p = std::to_chars(p, std::end(buf), dx).ptr;
+		*p++ = ',';
+		p = std::to_chars(p, std::end(buf), dy).ptr;
+		*p++ = 'h';
+		p = std::to_chars(p, std::end(buf), len).ptr;
+		p = std::copy_n("v1h-", 4, p);
+		p = std::to_chars(p, std::end(buf), len).ptr;
+		*p++ = 'z';
+		out.write(buf, p - buf);
+	};
+
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		<< "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 " << area.width() << " " << area.height()
+		<< "\"";
+	if (scale)
+		out << " width=\"" << area.width() * scale << "\" height=\"" << area.height() * scale << "\"";
+	out << " stroke=\"none\">\n<path d=\"";
+
+	// one sub-path per run of dark modules, each relative to the start of the previous one
+	int px = 0, py = 0;
+	ForEachDarkRun(area, [&](int x, int y, int len) {
+		putRun(x - px, y - py, len);
+		px = x, py = y;
+	});
+
+	out << "\"/>\n</svg>";
+}
+
+// fill count pixels starting at p with the pixel value px (of size n) using the given stride
+static void FillRun(uint8_t* p, int count, int stride, const uint8_t* px, int n)
+{
+	if (n == 1 && stride == 1)
+		std::memset(p, px[0], count);
+	else
+		for (int i = 0; i < count; ++i, p += stride)
+			std::memcpy(p, px, n);
+}
+
+ImageView WriteBarcodeToBuffer(const Barcode& barcode, uint8_t* data, int width, int height, ImageFormat format, int rowStride,
+							   int left, int top, const WriterOptions& opts)
+{
+	if (!data)
+		throw std::invalid_argument("Can not write a barcode into a NULL buffer");
+
+	// the ImageView validates the buffer geometry and computes the default row stride
+	ImageView target(data, width, height, format, rowStride);
+
+	auto area = SymbolArea(barcode, opts);
+	if (!area.data())
+		return {};
+
+	const int scale = std::max(1, ModuleScale(area, opts));
+	const int outWidth = area.width() * scale, outHeight = area.height() * scale;
+
+	if (left < 0 || top < 0 || left + outWidth > target.width() || top + outHeight > target.height())
+		throw std::invalid_argument("Barcode does not fit into the target buffer at the given position");
+
+	// opaque black and white pixel values in the target format (alpha is the channel not used by R, G and B)
+	const int n = PixStride(format);
+	uint8_t dark[4] = {0, 0, 0, 0}, light[4] = {0xff, 0xff, 0xff, 0xff};
+	if (n == 2 || n == 4)
+		dark[n == 2 ? 1 : 6 - RedIndex(format) - GreenIndex(format) - BlueIndex(format)] = 0xff;
+
+	for (int y = 0; y < area.height(); ++y)
+		for (int dy = 0; dy < scale; ++dy) {
+			uint8_t* dst = data + (top + y * scale + dy) * target.rowStride() + left * n;
+			for (int x = 0; x < area.width();) {
+				bool isDark = *area.data(x, y) == 0;
+				int end = x + 1;
+				while (end < area.width() && (*area.data(end, y) == 0) == isDark)
+					++end;
+				FillRun(dst, (end - x) * scale, n, isDark ? dark : light, n);
+				dst += (end - x) * scale * n;
+				x = end;
+			}
+		}
+
+	return target.cropped(left, top, outWidth, outHeight);
+}
+
+void WriteBarcodeToSVG(const Barcode& barcode, std::ostream& out, [[maybe_unused]] const WriterOptions& opts)
 {
-	auto zint = barcode.zint();
+	auto encoded = barcode.zint();
 
-	if (!zint)
-		return ToSVG(barcode.symbol());
+	// zint is only needed for what the module matrix does not contain: the human readable text and MaxiCode's hexagons
+	if (!encoded || !(opts.withHRT() || barcode.format() == BarcodeFormat::MaxiCode)) {
+		if (auto area = SymbolArea(barcode, opts); area.data())
+			WriteSVG(area, out, ModuleScale(area, opts));
+		return;
+	}
 
 #if defined(ZXING_WRITERS) && defined(ZXING_USE_ZINT)
-	auto resetOnExit = SetCommonWriterOptions(zint, opts);
+	auto zint = RenderSymbol(encoded, opts);
 
 	zint->output_options |= BARCODE_MEMORY_FILE;// | EMBED_VECTOR_FONT;
 	strcpy(zint->outfile, "null.svg");
 
-	CHECK(ZBarcode_Print(zint, opts.rotate()));
+	CHECK(ZBarcode_Print(zint.get(), opts.rotate()));
 
-	return std::string(reinterpret_cast<const char*>(zint->memfile), zint->memfile_size);
-#else
-	return {}; // unreachable code
+	out.write(reinterpret_cast<const char*>(zint->memfile), zint->memfile_size);
 #endif
 }
 
+std::string WriteBarcodeToSVG(const Barcode& barcode, const WriterOptions& opts)
+{
+	std::ostringstream res;
+	WriteBarcodeToSVG(barcode, res, opts);
+	return res.str();
+}
+
 Image WriteBarcodeToImage(const Barcode& barcode, [[maybe_unused]] const WriterOptions& opts)
 {
-	auto zint = barcode.zint();
+	auto encoded = barcode.zint();
 
-	if (!zint)
-		return ToImage(barcode._symbol->copy(), IsLinearCode(barcode.format()), opts);
+	if (!encoded)
+		return barcode._symbol ? ToImage(barcode._symbol->copy(), IsLinearCode(barcode.format()), opts) : Image();
 
 #if defined(ZXING_WRITERS) && defined(ZXING_USE_ZINT)
-	auto resetOnExit = SetCommonWriterOptions(zint, opts);
+	auto zint = RenderSymbol(encoded, opts);
 
-	CHECK(ZBarcode_Buffer(zint, opts.rotate()));
+	CHECK(ZBarcode_Buffer(zint.get(), opts.rotate()));
 
 #ifdef PRINT_DEBUG
 	printf("write symbol with size: %dx%d\n", zint->bitmap_width, zint->bitmap_height);
@@ -467,6 +1100,8 @@ std::string WriteBarcodeToUtf8(const Barcode& barcode, [[maybe_unused]] const Wr
 	std::ostringstream res;
 	bool inverted = false; // TODO: take from WriterOptions
 
+	// block characters are drawn for the light (non-zero) modules, i.e. for a terminal with a dark background
+
 	for (int y = 0; y < iv.height(); y += 2) {
 		for (int x = 0; x < iv.width(); ++x) {
 			int tp = bool(*iv.data(x, y)) ^ inverted;
@@ -10,30 +10,38 @@
 #include "Barcode.h"
 #include "ImageView.h"
 
+#include <cstdint>
+#include <iosfwd>
+#include <iterator>
 #include <memory>
 #include <string_view>
-
-extern "C" struct zint_symbol;
+#include <type_traits>
+#include <vector>
 
 namespace ZXing {
 
+/**
+ * The parameters of the barcode creation. The creation functions only read from it, so a CreatorOptions object can be
+ * shared between threads.
+ *
+ * Note: the former zint() accessor, which handed out the zint_symbol used for the next creation, has been removed
+ * (API break). The zint_symbol of a created symbol is available via Barcode::zint().
+ */
 class CreatorOptions
 {
 	struct Data;
 
 	std::unique_ptr<Data> d;
 
-	friend Barcode CreateBarcode(const void* data, int size, int mode, const CreatorOptions& options);
-
 public:
 	CreatorOptions(BarcodeFormat format);
 
 	~CreatorOptions();
+	CreatorOptions(const CreatorOptions&);
+	CreatorOptions& operator=(const CreatorOptions&);
 	CreatorOptions(CreatorOptions&&);
 	CreatorOptions& operator=(CreatorOptions&&);
 
-	zint_symbol* zint() const;
-
 #define ZX_PROPERTY(TYPE, NAME) \
 	TYPE NAME() const noexcept; \
 	CreatorOptions& NAME(TYPE v)&; \
@@ -44,6 +52,18 @@ public:
 	ZX_PROPERTY(bool, forceSquareDataMatrix)
 	ZX_PROPERTY(std::string, ecLevel)
 
+	/// Decode the created symbol to fill in the Barcode meta data and throw if that fails (slow, default: false)
+	ZX_PROPERTY(bool, verify)
+
+	/// The number of threads CreateBarcodesFromText may use, 0 (default) means one per hardware thread
+	ZX_PROPERTY(int, maxThreadCount)
+
+	/// Split the content into multiple mode segments if that results in a smaller symbol (QRCode only, default: true)
+	ZX_PROPERTY(bool, optimizeSegments)
+
+	/// Find the shortest sequence of encodations instead of using the look-ahead heuristic (DataMatrix only, default: false)
+	ZX_PROPERTY(bool, minimalDataMatrix)
+
 #undef ZX_PROPERTY
 };
 
@@ -66,6 +86,65 @@ Barcode CreateBarcodeFromText(std::string_view contents, const CreatorOptions& o
  */
 Barcode CreateBarcodeFromBytes(const void* data, int size, const CreatorOptions& options);
 
+/**
+ * Generate one barcode per unicode text, spread over up to options.maxThreadCount() threads
+ *
+ * If any of the texts can not be encoded, the first exception is rethrown after all threads have finished.
+ *
+ * The results are rendered like those of CreateBarcodeFromText. With zint, the symbols of formats that are rendered from
+ * their module matrix alone (all 2D formats except MaxiCode) are encoded into a reused zint_symbol and do not keep it,
+ * the others (MaxiCode and the linear formats with their human readable text) get their own one.
+ *
+ * @param contents  array of UTF-8 strings to encode
+ * @param count  size of the array
+ * @param options  CreatorOptions (including BarcodeFormat)
+ * @return #Barcodes  generated barcodes in the order of contents
+ */
+Barcodes CreateBarcodesFromText(const std::string_view* contents, int count, const CreatorOptions& options);
+
+template <typename R>
+Barcodes CreateBarcodesFromText(const R& contents, const CreatorOptions& options)
+{
+	if constexpr (std::is_same_v<std::decay_t<decltype(*std::begin(contents))>, std::string_view>) {
+		return CreateBarcodesFromText(std::data(contents), static_cast<int>(std::size(contents)), options);
+	} else {
+		std::vector<std::string_view> views(std::begin(contents), std::end(contents));
+		return CreateBarcodesFromText(views.data(), static_cast<int>(views.size()), options);
+	}
+}
+
+/**
+ * A bounded cache of created barcodes for applications that create the same symbols over and over again
+ *
+ * Entries are keyed by the content and all CreatorOptions that influence the result. When the cache is full, the least
+ * recently used entry is dropped. The returned barcodes are shared and must not be modified. All member functions may
+ * be called concurrently; a missing barcode is created outside of the internal lock.
+ */
+class BarcodeCache
+{
+	struct Data;
+
+	std::unique_ptr<Data> d;
+
+public:
+	/// capacity is the maximum number of cached barcodes, 0 disables caching (but still counts the misses)
+	explicit BarcodeCache(int capacity);
+	~BarcodeCache();
+
+	/// like CreateBarcodeFromText but returns the cached barcode if there is one
+	std::shared_ptr<const Barcode> createFromText(std::string_view contents, const CreatorOptions& options);
+	/// like CreateBarcodeFromBytes but returns the cached barcode if there is one
+	std::shared_ptr<const Barcode> createFromBytes(const void* data, int size, const CreatorOptions& options);
+
+	int capacity() const noexcept;
+	int size() const;
+	/// number of create calls answered from the cache resp. that had to create a new barcode, to help sizing it
+	int64_t hits() const;
+	int64_t misses() const;
+
+	void clear();
+};
+
 #if __cplusplus > 201703L
 Barcode CreateBarcodeFromText(std::u8string_view contents, const CreatorOptions& options);
 
@@ -121,6 +200,19 @@ public:
  */
 std::string WriteBarcodeToSVG(const Barcode& barcode, const WriterOptions& options = {});
 
+/**
+ * Write barcode symbol as SVG to an output stream
+ *
+ * Unless zint is needed for the human readable text or MaxiCode, the output is a single path with one sub-path per
+ * horizontal run of dark modules, written without intermediate buffers. The viewBox is measured in modules, width
+ * and height are set from options.scale() or options.sizeHint() like in WriteBarcodeToBuffer.
+ *
+ * @param barcode  Barcode to write
+ * @param out  stream to append the SVG document to
+ * @param options  WriterOptions to parameterize rendering
+ */
+void WriteBarcodeToSVG(const Barcode& barcode, std::ostream& out, const WriterOptions& options = {});
+
 /**
  * Write barcode symbol to a utf8 string using graphical characters (e.g. '▀')
  *
@@ -139,6 +231,28 @@ std::string WriteBarcodeToUtf8(const Barcode& barcode, const WriterOptions& opti
  */
 Image WriteBarcodeToImage(const Barcode& barcode, const WriterOptions& options = {});
 
+/**
+ * Write barcode symbol into an existing, caller owned image buffer (e.g. a page raster) without intermediate images
+ *
+ * The symbol is scaled by options.scale() (or the largest integer scale such that it fits into options.sizeHint(),
+ * at least 1), rotated clockwise by options.rotate() (a multiple of 90) and placed with its top left corner at
+ * (left, top). Dark and light modules are written as opaque black and white pixels in the given format. Pixels
+ * outside of the symbol are left untouched.
+ *
+ * @param barcode  Barcode to write
+ * @param data  pointer to the first pixel of the buffer to draw into
+ * @param width  width of the buffer in pixels
+ * @param height  height of the buffer in pixels
+ * @param format  pixel format of the buffer
+ * @param rowStride  number of bytes from one row to the next (0 means width * pixel size)
+ * @param left  x coordinate of the top left corner of the symbol in the buffer
+ * @param top  y coordinate of the top left corner of the symbol in the buffer
+ * @param options  WriterOptions to parameterize rendering
+ * @return ImageView  the region of the buffer covered by the symbol
+ */
+ImageView WriteBarcodeToBuffer(const Barcode& barcode, uint8_t* data, int width, int height, ImageFormat format, int rowStride,
+							   int left, int top, const WriterOptions& options = {});
+
 } // ZXing
 
 #endif // ZXING_EXPERIMENTAL_API
@@ -215,12 +215,16 @@ uint8_t* ZXing_Barcode_bytesECI(const ZXing_Barcode* barcode, int* len)
 	return copy(barcode->bytesECI(), len);
 }
 
+char* ZXing_Barcode_text(const ZXing_Barcode* barcode)
+{
+	return copy<std::string_view, char*>(barcode->textView()); // borrow the cached text instead of rendering a temporary
+}
+
 #define ZX_GETTER(TYPE, GETTER, TRANS) \
 	TYPE ZXing_Barcode_##GETTER(const ZXing_Barcode* barcode) { return TRANS(barcode->GETTER()); }
 
 ZX_GETTER(ZXing_BarcodeFormat, format, static_cast<ZXing_BarcodeFormat>)
 ZX_GETTER(ZXing_ContentType, contentType, static_cast<ZXing_ContentType>)
-ZX_GETTER(char*, text, copy)
 ZX_GETTER(char*, ecLevel, copy)
 ZX_GETTER(char*, symbologyIdentifier, copy)
 ZX_GETTER(ZXing_Position, position, transmute_cast<ZXing_Position>)
@@ -348,6 +352,9 @@ void ZXing_CreatorOptions_delete(ZXing_CreatorOptions* opts)
 
 ZX_PROPERTY(bool, readerInit, ReaderInit)
 ZX_PROPERTY(bool, forceSquareDataMatrix, ForceSquareDataMatrix)
+ZX_PROPERTY(bool, verify, Verify)
+ZX_PROPERTY(bool, optimizeSegments, OptimizeSegments)
+ZX_PROPERTY(bool, minimalDataMatrix, MinimalDataMatrix)
 
 #undef ZX_PROPERTY
 
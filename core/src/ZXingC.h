@@ -276,6 +276,15 @@ bool ZXing_CreatorOptions_getReaderInit(const ZXing_CreatorOptions* opts);
 void ZXing_CreatorOptions_setForceSquareDataMatrix(ZXing_CreatorOptions* opts, bool forceSquareDataMatrix);
 bool ZXing_CreatorOptions_getForceSquareDataMatrix(const ZXing_CreatorOptions* opts);
 
+void ZXing_CreatorOptions_setVerify(ZXing_CreatorOptions* opts, bool verify);
+bool ZXing_CreatorOptions_getVerify(const ZXing_CreatorOptions* opts);
+
+void ZXing_CreatorOptions_setOptimizeSegments(ZXing_CreatorOptions* opts, bool optimizeSegments);
+bool ZXing_CreatorOptions_getOptimizeSegments(const ZXing_CreatorOptions* opts);
+
+void ZXing_CreatorOptions_setMinimalDataMatrix(ZXing_CreatorOptions* opts, bool minimalDataMatrix);
+bool ZXing_CreatorOptions_getMinimalDataMatrix(const ZXing_CreatorOptions* opts);
+
 void ZXing_CreatorOptions_setEcLevel(ZXing_CreatorOptions* opts, const char* ecLevel);
 char* ZXing_CreatorOptions_getEcLevel(const ZXing_CreatorOptions* opts);
 
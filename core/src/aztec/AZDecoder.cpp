@@ -16,8 +16,10 @@
 #include "ZXTestSupport.h"
 #include "ZXAlgorithms.h"
 
+#include <array>
 #include <cctype>
 #include <cstring>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <utility>
@@ -65,22 +67,23 @@ static int TotalBitsInLayer(int layers, bool compact)
 	return ((compact ? 88 : 112) + 16 * layers) * layers;
 }
 
+static int MatrixSize(int layers, bool compact)
+{
+	return compact ? 4 * layers + 11 : 4 * layers + 2 * ((2 * layers + 6) / 15) + 15;
+}
+
 /**
-* Gets the array of bits from an Aztec Code matrix
-*
-* @return the array of bits
+* Computes the positions (y * width + x) of all data modules of a symbol in the order in which they are read
 */
-static BitArray ExtractBits(const DetectorResult& ddata)
+static std::vector<uint16_t> ComputeModulePositions(int layers, bool compact)
 {
-	bool compact = ddata.isCompact();
-	int layers = ddata.nbLayers();
 	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
+	int matrixSize = MatrixSize(layers, compact);
 	std::vector<int> map(baseMatrixSize, 0);
 
 	if (compact) {
 		std::iota(map.begin(), map.end(), 0);
 	} else {
-		int matrixSize = baseMatrixSize + 1 + 2 * ((baseMatrixSize / 2 - 1) / 15);
 		int origCenter = baseMatrixSize / 2;
 		int center = matrixSize / 2;
 		for (int i = 0; i < origCenter; i++) {
@@ -89,8 +92,10 @@ static BitArray ExtractBits(const DetectorResult& ddata)
 			map[origCenter + i] = center + newOffset + 1;
 		}
 	}
-	auto& matrix = ddata.bits();
-	BitArray rawbits(TotalBitsInLayer(layers, compact));
+
+	auto pos = [&](int x, int y) { return narrow_cast<uint16_t>(map[y] * matrixSize + map[x]); };
+
+	std::vector<uint16_t> res(TotalBitsInLayer(layers, compact));
 	for (int i = 0, rowOffset = 0; i < layers; i++) {
 		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
 		// The top-left most point of this layer is <low, low> (not including alignment lines)
@@ -102,24 +107,63 @@ static BitArray ExtractBits(const DetectorResult& ddata)
 			int colOffset = j * 2;
 			for (int k = 0; k < 2; k++) {
 				// left column
-				rawbits.set(rowOffset + 0 * rowSize + colOffset + k, matrix.get(map[low + k], map[low + j]));
+				res[rowOffset + 0 * rowSize + colOffset + k] = pos(low + k, low + j);
 				// bottom row
-				rawbits.set(rowOffset + 2 * rowSize + colOffset + k, matrix.get(map[low + j], map[high - k]));
+				res[rowOffset + 2 * rowSize + colOffset + k] = pos(low + j, high - k);
 				// right column
-				rawbits.set(rowOffset + 4 * rowSize + colOffset + k, matrix.get(map[high - k], map[high - j]));
+				res[rowOffset + 4 * rowSize + colOffset + k] = pos(high - k, high - j);
 				// top row
-				rawbits.set(rowOffset + 6 * rowSize + colOffset + k, matrix.get(map[high - j], map[low + k]));
+				res[rowOffset + 6 * rowSize + colOffset + k] = pos(high - j, low + k);
 			}
 		}
 		rowOffset += rowSize * 8;
 	}
-	return rawbits;
+	return res;
+}
+
+/**
+* Returns the cached module positions for each of the 4 compact and 32 full symbol sizes
+*/
+static const std::vector<uint16_t>& ModulePositions(int layers, bool compact)
+{
+	static std::array<std::vector<uint16_t>, 4 + 32> cache;
+	static std::array<std::once_flag, 4 + 32> once;
+
+	int i = (compact ? 0 : 4) + layers - 1;
+	std::call_once(once[i], [&] { cache[i] = ComputeModulePositions(layers, compact); });
+	return cache[i];
 }
 
 /**
-* @brief Performs RS error correction on an array of bits.
+* Gathers the code words from an Aztec Code matrix
 */
-static BitArray CorrectBits(const DetectorResult& ddata, const BitArray& rawbits)
+static std::vector<int> ExtractCodewords(const DetectorResult& ddata, int codewordSize)
+{
+	bool compact = ddata.isCompact();
+	int layers = ddata.nbLayers();
+	auto& matrix = ddata.bits();
+
+	if (layers < 1 || layers > (compact ? 4 : 32) || matrix.width() != MatrixSize(layers, compact)
+		|| matrix.height() != matrix.width())
+		throw FormatError("Invalid symbol size");
+
+	auto& positions = ModulePositions(layers, compact);
+	const auto* modules = matrix.row(0).begin();
+
+	// skip the leading bits that do not form a complete code word
+	auto pos = positions.begin() + Size(positions) % codewordSize;
+	std::vector<int> res(Size(positions) / codewordSize);
+	for (int& word : res)
+		for (int i = 0; i < codewordSize; ++i)
+			word = (word << 1) | (modules[*pos++] != 0);
+
+	return res;
+}
+
+/**
+* @brief Performs RS error correction on the code words of an Aztec Code matrix.
+*/
+static BitArray CorrectBits(const DetectorResult& ddata)
 {
 	const GenericGF* gf = nullptr;
 	int codewordSize;
@@ -138,15 +182,15 @@ static BitArray CorrectBits(const DetectorResult& ddata, const BitArray& rawbits
 		gf = &GenericGF::AztecData12();
 	}
 
-	int numCodewords = Size(rawbits) / codewordSize;
+	auto dataWords = ExtractCodewords(ddata, codewordSize);
+
+	int numCodewords = Size(dataWords);
 	int numDataCodewords = ddata.nbDatablocks();
 	int numECCodewords = numCodewords - numDataCodewords;
 
 	if (numCodewords < numDataCodewords)
 		throw FormatError("Invalid number of code words");
 
-	auto dataWords = ToInts<int>(rawbits, codewordSize, numCodewords, Size(rawbits) % codewordSize);
-
 	if (!ReedSolomonDecode(*gf, dataWords, numECCodewords))
 		throw ChecksumError();
 
@@ -365,7 +409,7 @@ DecoderResult Decode(const DetectorResult& detectorResult)
 			// This is a rune - just return the rune value
 			return DecodeRune(detectorResult);
 		}
-		auto bits = CorrectBits(detectorResult, ExtractBits(detectorResult));
+		auto bits = CorrectBits(detectorResult);
 		return Decode(bits);
 	} catch (Error e) {
 		return e;
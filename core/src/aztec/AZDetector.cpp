@@ -20,6 +20,7 @@
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
+#include <cstring>
 #include <optional>
 #include <vector>
 
@@ -125,108 +126,237 @@ static std::vector<ConcentricPattern> FindPureFinderPattern(const BitMatrix& ima
 		return {};
 }
 
-static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+static bool Equal8(const uint8_t* a, const uint8_t* b)
 {
-	std::vector<ConcentricPattern> res;
-
-	[[maybe_unused]] int N = 0;
+	uint64_t va, vb;
+	std::memcpy(&va, a, sizeof(va));
+	std::memcpy(&vb, b, sizeof(vb));
+	return va == vb;
+}
 
-#if 0 // reference algorithm for finding aztec center candidates
-	constexpr auto PATTERN = FixedPattern<7, 7>{1, 1, 1, 1, 1, 1, 1};
-	auto l0 = image.row(0);
-	std::vector<uint8_t> line(l0.begin(), l0.end());
+/**
+ * Incremental variant of the 'ring counting' approach: for every column we keep the number of edges crossed on the way
+ * from the top border down to the current row. Neighboring columns are not allowed to differ by more than 1 (keeping the
+ * parity, which is the color of the current pixel), which turns the count into the number of rings surrounding a pixel.
+ * The center of a bullseye shows up as a plateau of an odd count >= 5 that is higher than its left and right neighbor.
+ *
+ * Since subsequent image rows are mostly identical, the work per row is proportional to the number of columns where the
+ * current row differs from the previous one: unchanged stretches are skipped 64 or 8 pixels at a time and the neighbor
+ * constraint can only be violated at the ends of runs of changed columns (and next to already lowered ones).
+ * New candidates are reported via onCandidate(center, plateauWidth).
+ */
+template <typename F>
+static void ScanRingCounts(const BitMatrix& image, F&& onCandidate)
+{
 	const int width = image.width();
+	if (width < 3 || image.height() < 3)
+		return;
 
-	int skip = tryHarder ? 1 : std::clamp(image.height() / 100, 1, 3);
-	int margin = skip;
-	for (int y = margin; y < image.height() - margin; y += skip) {
-		auto lc = image.row(y).begin() + 1;
-		auto lp = image.row(y - skip).begin() + 1;
-		line.front() = image.get(0, y);
-		// update line and swipe right
-		for (int x = 1; x < image.width(); ++x) {
-			line[x] += *lc++ != *lp++;
-			while (line[x] > line[x - 1] + 1)
-				line[x] -= 2;
+	struct Span
+	{
+		int first, last;
+	};
+
+	std::vector<uint16_t> rings(width);
+	std::vector<Span> changed;
+	std::vector<int> loweredL, loweredR;
+
+	// lower rings[x] to at most rings[n] + 1 while keeping its parity
+	auto lower = [&rings](int x, int n, std::vector<int>& lowered) {
+		auto& r = rings[x];
+		if (r <= rings[n] + 1)
+			return false;
+		r = rings[n] + ((r - rings[n]) & 1);
+		lowered.push_back(x);
+		return true;
+	};
+
+	auto lp = image.row(0).begin();
+	for (int x = 0; x < width; ++x)
+		rings[x] = lp[x] != 0;
+
+	for (int y = 1; y < image.height(); ++y) {
+		auto lc = image.row(y).begin();
+		changed.clear();
+		loweredL.clear();
+		loweredR.clear();
+
+		// count the new edges and collect the runs of changed columns
+		bool inRun = false;
+		auto update = [&](int x, int n) {
+			unsigned changes = 0;
+			for (int i = 0; i < n; ++i) {
+				bool c = lc[x + i] != lp[x + i];
+				rings[x + i] += c;
+				changes |= c << i;
+			}
+			// each set bit marks the start or the end of a run of changed columns
+			for (auto edges = changes ^ ((changes << 1) | inRun); edges; edges &= edges - 1, inRun = !inRun) {
+				int pos = x + BitHacks::NumberOfTrailingZeros(edges);
+				if (inRun)
+					changed.back().last = pos - 1;
+				else
+					changed.push_back({pos, pos});
+			}
+		};
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			if (!inRun) {
+				// skip over unchanged parts quickly
+				while (x + 64 <= width && std::memcmp(lc + x, lp + x, 64) == 0)
+					x += 64;
+				if (x + 8 > width)
+					break;
+				if (Equal8(lc + x, lp + x))
+					continue;
+			}
+			update(x, 8);
 		}
-		// swipe left
-		line.back() = image.get(width - 1, y);
-		for (int x = width - 2; x > 0; --x)
-			while (line[x] > line[x + 1] + 1)
-				line[x] -= 2;
-
-		int first = 0, last = 0;
-		for (int x = 1; x < width - 5; ++x) {
-			if (line[x] > line[x - 1] && line[x] >= 5 && line[x] % 2 == 1)
-				first = x;
-			else
-				continue;
-			while (line[x] == line[x + 1])
-				++x;
-			last = x;
-			if (line[last + 1] < line[last]) {
-				auto p = centered(PointI((first + last) / 2, y));
-				// make sure p is not 'inside' an already found pattern area
-				if (FindIf(res, [p](const auto& old) { return distance(p, old) < old.size / 2; }) == res.end()) {
-					++N;
-					auto pattern = LocateConcentricPattern(image, PATTERN, p, image.width() / 3);
-					if (pattern){
-						log(*pattern, 2);
-						res.push_back(*pattern);
-					}
-				}
+		update(x, width - x);
+		if (inRun)
+			changed.back().last = width - 1;
+
+		if (changed.empty()) {
+			lp = lc;
+			continue;
+		}
+
+		// the first and last column represent the white surrounding of the image and can only be 0 or 1
+		auto resetBorder = [&](int x) {
+			if (rings[x] > 1) {
+				rings[x] = lc[x] != 0;
+				loweredL.push_back(x);
+			}
+		};
+
+		// enforce the neighbor constraint from left to right ...
+		resetBorder(0);
+		int done = 0;
+		auto sweepRight = [&](int x) {
+			for (x = std::max(x, done + 1); x < width - 1; ++x) {
+				done = x;
+				if (!lower(x, x - 1, loweredL))
+					break;
+			}
+		};
+		if (!loweredL.empty())
+			sweepRight(1);
+		for (auto& span : changed)
+			sweepRight(span.first);
+		resetBorder(width - 1);
+
+		// ... and from right to left, starting at the end of each run and left of each lowered column (both in descending order)
+		done = width - 1;
+		auto sweepLeft = [&](int x) {
+			for (x = std::min(x, done - 1); x > 0; --x) {
+				done = x;
+				if (!lower(x, x + 1, loweredR))
+					break;
 			}
+		};
+		for (int i = Size(changed) - 1, j = Size(loweredL) - 1; i >= 0 || j >= 0;) {
+			int a = i >= 0 ? changed[i].last : -1;
+			int b = j >= 0 ? loweredL[j] - 1 : -1;
+			if (a >= b)
+				sweepLeft(a), --i;
+			else
+				sweepLeft(b), --j;
 		}
+
+		// look for new plateaus next to all modified columns
+		int lastEnd = 0;
+		auto checkPlateau = [&](int x) {
+			if (x <= lastEnd || x > width - 2)
+				return;
+			int v = rings[x];
+			if (v < 5 || v % 2 == 0)
+				return;
+			// the first and last column are always 0 or 1, so we never run out of bounds here
+			int s = x, e = x;
+			while (rings[s - 1] == v)
+				--s;
+			while (rings[e + 1] == v)
+				++e;
+			lastEnd = e;
+			if (rings[s - 1] < v && rings[e + 1] < v) {
+				// the plateau just showed up, i.e. this is the top row of the (supposedly square) center module
+				int w = e - s + 1;
+				onCandidate(PointF((s + e + 1) / 2.0, y + w / 2.0), w);
+			}
+		};
+		for (auto& span : changed)
+			for (int x = span.first - 1; x <= span.last + 1; ++x)
+				checkPlateau(x);
+		lastEnd = 0;
+		for (int l : loweredL)
+			for (int x = l - 1; x <= l + 1; ++x)
+				checkPlateau(x);
+		lastEnd = 0;
+		for (auto l = loweredR.rbegin(); l != loweredR.rend(); ++l)
+			for (int x = *l - 1; x <= *l + 1; ++x)
+				checkPlateau(x);
+
+		lp = lc;
 	}
-#else // own algorithm based on PatternRow processing (between 0% and 100% faster than reference algo depending on input)
-	int skip = tryHarder ? 1 : std::clamp(image.height() / 2 / 100, 1, 5);
-	int margin = tryHarder ? 5 : image.height() / 4;
+}
+
+static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder, bool patternRowScan)
+{
+	std::vector<ConcentricPattern> res;
 
-	PatternRow row;
+	[[maybe_unused]] int N = 0;
 
-	for (int y = margin; y < image.height() - margin; y += skip)
-	{
-		GetPatternRow(image, y, row, false);
-		PatternView next = row;
-		next.shift(1); // the center pattern we are looking for starts with white and is 7 wide (compact code)
+	auto checkCandidate = [&](PointF p, int spreadH) {
+		// make sure p is not 'inside' an already found pattern area
+		if (IsInsideFoundPattern(res, p))
+			return;
+
+		++N;
+		log(p, 1);
+
+		auto pattern = LocateAztecCenter(image, p, spreadH);
+		if (pattern) {
+			log(*pattern, 3);
+			assert(image.get(*pattern));
+			res.push_back(*pattern);
+		}
+	};
+
+	if (tryHarder && !patternRowScan) {
+		// every row gets visited, so carry the ring counts from row to row instead of building a PatternRow for each one
+		ScanRingCounts(image, [&](PointF p, int w) {
+			auto cur = BitMatrixCursorI(image, PointI(p), {1, 0});
+			if (auto pattern = ReadSymmetricPattern<7>(cur, 14 * w))
+				checkCandidate(p, Reduce(*pattern));
+		});
+	} else {
+		// PatternRow based processing of every n-th row (between 0% and 100% faster than the original ring counting
+		// algorithm in this setting, depending on input)
+		int skip = tryHarder ? 1 : std::clamp(image.height() / 2 / 100, 1, 5);
+		int margin = tryHarder ? 5 : image.height() / 4;
+
+		PatternRow row;
+
+		for (int y = margin; y < image.height() - margin; y += skip) {
+			GetPatternRow(image, y, row, false);
+			PatternView next = row;
+			next.shift(1); // the center pattern we are looking for starts with white and is 7 wide (compact code)
 
 #if 1
-		while (next = FindAztecCenterPattern(next), next.isValid()) {
+			while (next = FindAztecCenterPattern(next), next.isValid()) {
 #else
-		constexpr auto PATTERN = FixedPattern<7, 7>{1, 1, 1, 1, 1, 1, 1};
-		while (next = FindLeftGuard(next, 0, PATTERN, 0.5), next.isValid()) {
+			constexpr auto PATTERN = FixedPattern<7, 7>{1, 1, 1, 1, 1, 1, 1};
+			while (next = FindLeftGuard(next, 0, PATTERN, 0.5), next.isValid()) {
 #endif
-			PointF p(next.pixelsInFront() + next[0] + next[1] + next[2] + next[3] / 2.0, y + 0.5);
+				PointF p(next.pixelsInFront() + next[0] + next[1] + next[2] + next[3] / 2.0, y + 0.5);
 
-			// make sure p is not 'inside' an already found pattern area
-			bool found = false;
-			for (auto old = res.rbegin(); old != res.rend(); ++old) {
-				// search from back to front, stop once we are out of range due to the y-coordinate
-				if (p.y - old->y > old->size / 2)
-					break;
-				if (distance(p, *old) < old->size / 2) {
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) {
-				++N;
-				log(p, 1);
+				checkCandidate(p, next.sum());
 
-				auto pattern = LocateAztecCenter(image, p, next.sum());
-				if (pattern) {
-					log(*pattern, 3);
-					assert(image.get(*pattern));
-					res.push_back(*pattern);
-				}
+				next.skipPair();
+				next.extend();
 			}
-
-			next.skipPair();
-			next.extend();
 		}
 	}
-#endif
 
 #ifdef PRINT_DEBUG
 	printf("\n# checked centeres: %d, # found centers: %d\n", N, Size(res));
@@ -348,14 +478,14 @@ DetectorResult Detect(const BitMatrix& image, bool isPure, bool tryHarder)
 	return FirstOrDefault(Detect(image, isPure, tryHarder, 1));
 }
 
-DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols)
+DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols, bool patternRowScan)
 {
 #ifdef PRINT_DEBUG
 	LogMatrixWriter lmw(log, image, 5, "az-log.pnm");
 #endif
 
 	DetectorResults res;
-	auto fps = isPure ? FindPureFinderPattern(image) : FindFinderPatterns(image, tryHarder);
+	auto fps = isPure ? FindPureFinderPattern(image) : FindFinderPatterns(image, tryHarder, patternRowScan);
 	for (const auto& fp : fps) {
 		auto fpQuad = FindConcentricPatternCorners(image, fp, fp.size, 3);
 		if (!fpQuad)
@@ -19,7 +19,9 @@ class DetectorResult;
 DetectorResult Detect(const BitMatrix& image, bool isPure, bool tryHarder = true);
 
 using DetectorResults = std::vector<DetectorResult>;
-DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols);
+/// with tryHarder, every row is scanned via incrementally updated ring counts, or like in the default mode via
+/// PatternRow if patternRowScan is set (slower, but retries each bullseye on every row it crosses)
+DetectorResults Detect(const BitMatrix& image, bool isPure, bool tryHarder, int maxSymbols, bool patternRowScan = false);
 
 } // Aztec
 } // ZXing
@@ -21,20 +21,7 @@ namespace ZXing::Aztec {
 
 Barcode Reader::decode(const BinaryBitmap& image) const
 {
-	auto binImg = image.getBitMatrix();
-	if (binImg == nullptr)
-		return {};
-	
-	DetectorResult detectorResult = Detect(*binImg, _opts.isPure(), _opts.tryHarder());
-	if (!detectorResult.isValid())
-		return {};
-
-	auto decodeResult = Decode(detectorResult)
-							.setReaderInit(detectorResult.readerInit())
-							.setIsMirrored(detectorResult.isMirrored())
-							.setVersionNumber(detectorResult.nbLayers());
-
-	return Barcode(std::move(decodeResult), std::move(detectorResult), BarcodeFormat::Aztec);
+	return FirstOrDefault(decode(image, 1));
 }
 
 Barcodes Reader::decode(const BinaryBitmap& image, int maxSymbols) const
@@ -42,21 +29,28 @@ Barcodes Reader::decode(const BinaryBitmap& image, int maxSymbols) const
 	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr)
 		return {};
-	
-	auto detRess = Detect(*binImg, _opts.isPure(), _opts.tryHarder(), maxSymbols);
-
-	Barcodes baracodes;
-	for (auto&& detRes : detRess) {
-		auto decRes =
-			Decode(detRes).setReaderInit(detRes.readerInit()).setIsMirrored(detRes.isMirrored()).setVersionNumber(detRes.nbLayers());
-		if (decRes.isValid(_opts.returnErrors())) {
-			baracodes.emplace_back(std::move(decRes), std::move(detRes), BarcodeFormat::Aztec);
-			if (maxSymbols > 0 && Size(baracodes) >= maxSymbols)
-				break;
+
+	auto decode = [&](bool patternRowScan) {
+		Barcodes baracodes;
+		for (auto&& detRes : Detect(*binImg, _opts.isPure(), _opts.tryHarder(), maxSymbols, patternRowScan)) {
+			auto decRes =
+				Decode(detRes).setReaderInit(detRes.readerInit()).setIsMirrored(detRes.isMirrored()).setVersionNumber(detRes.nbLayers());
+			if (decRes.isValid(_opts.returnErrors())) {
+				baracodes.emplace_back(std::move(decRes), std::move(detRes), BarcodeFormat::Aztec);
+				if (maxSymbols > 0 && Size(baracodes) >= maxSymbols)
+					break;
+			}
 		}
-	}
+		return baracodes;
+	};
+
+	auto res = decode(false);
+	// the ring count scan of tryHarder reports each bullseye only on the row where its center shows up first, a speckle
+	// or ring gap there loses the symbol. Fall back to the PatternRow scan, which retries on every row.
+	if (res.empty() && _opts.tryHarder() && !_opts.isPure())
+		res = decode(true);
 
-	return baracodes;
+	return res;
 }
 
 } // namespace ZXing::Aztec
@@ -116,6 +116,11 @@ public:
 		return _symbolInfo;
 	}
 
+	/// the smallest symbol matching the constraints that can hold len data codewords or nullptr, does not change the state
+	const SymbolInfo* lookupSymbolInfo(int len) const {
+		return SymbolInfo::Lookup(len, _shape, _minWidth, _minHeight, _maxWidth, _maxHeight);
+	}
+
 	void resetSymbolInfo() {
 		_symbolInfo = nullptr;
 	}
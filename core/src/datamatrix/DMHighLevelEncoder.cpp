@@ -21,6 +21,8 @@
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ZXing::DataMatrix {
 
@@ -840,6 +842,263 @@ namespace Base256Encoder {
 
 } // Base256Encoder
 
+/**
+* Finds the encodation with the least number of codewords by a shortest path search over the message. The nodes are the
+* positions between the characters times the current encodation plus the number of values in the last incomplete
+* C40/Text/X12 triplet or EDIFACT quadruple, so every edge has an exact codeword cost. All latches go via ASCII, like in
+* the decoder. Base 256 segments return to ASCII at their end and are added as edges spanning several characters.
+* The memory is bounded by the 14 nodes per character of a message that fits into the largest symbol.
+*/
+namespace MinimalEncoder {
+
+	enum State : int8_t
+	{
+		ASCII, C40_0, C40_1, C40_2, TEXT_0, TEXT_1, TEXT_2, X12_0, X12_1, X12_2, EDF_0, EDF_1, EDF_2, EDF_3,
+		NUM_STATES,
+		B256 = NUM_STATES, // used as prevState only: a Base 256 segment from ASCII at prevPos
+	};
+
+	static const int MAX_DATA_CODEWORDS = 1558; // 144x144
+
+	static int Encodation(int state)
+	{
+		constexpr int ENCODATIONS[NUM_STATES] = {ASCII_ENCODATION,   C40_ENCODATION,     C40_ENCODATION,     C40_ENCODATION,
+												 TEXT_ENCODATION,    TEXT_ENCODATION,    TEXT_ENCODATION,    X12_ENCODATION,
+												 X12_ENCODATION,     X12_ENCODATION,     EDIFACT_ENCODATION, EDIFACT_ENCODATION,
+												 EDIFACT_ENCODATION, EDIFACT_ENCODATION};
+		return ENCODATIONS[state];
+	}
+
+	struct Node
+	{
+		int cost = std::numeric_limits<int>::max();
+		int prevPos = -1;
+		int8_t prevState = -1;
+	};
+
+	static int EncodeC40Char(int state, int c, std::string& values)
+	{
+		return state < TEXT_0 ? C40Encoder::EncodeChar(c, values) : DMTextEncoder::EncodeChar(c, values);
+	}
+
+	static void EncodeMinimal(EncoderContext& context)
+	{
+		const std::string& msg = context.message();
+		const int start = context.currentPos(), end = context.totalMessageCharCount();
+
+		std::vector<std::array<Node, NUM_STATES>> nodes(end - start + 1);
+		auto node = [&](int pos, int state) -> Node& { return nodes[pos - start][state]; };
+		auto relax = [&](int pos, int state, int prevPos, int prevState, int cost) {
+			auto& n = node(pos, state);
+			if (cost < n.cost)
+				n = {cost, prevPos, narrow_cast<int8_t>(prevState)};
+		};
+
+		node(start, ASCII).cost = context.codewordCount();
+
+		std::string values;
+		for (int pos = start; pos <= end; ++pos) {
+			auto& cur = nodes[pos - start];
+
+			// unlatch to ASCII after complete triplets, the EDIFACT unlatch value completes the current codeword
+			for (int s : {C40_0, TEXT_0, X12_0})
+				if (cur[s].cost != std::numeric_limits<int>::max())
+					relax(pos, ASCII, pos, s, cur[s].cost + 1);
+			for (int r = 0; r < 4; ++r)
+				if (cur[EDF_0 + r].cost != std::numeric_limits<int>::max())
+					relax(pos, ASCII, pos, EDF_0 + r, cur[EDF_0 + r].cost + (r < 3));
+
+			if (pos == end)
+				break;
+
+			if (std::min_element(cur.begin(), cur.end(), [](auto& a, auto& b) { return a.cost < b.cost; })->cost > MAX_DATA_CODEWORDS)
+				throw std::invalid_argument("Can't find a symbol arrangement that matches the message.");
+
+			int c = msg[pos] & 0xff;
+
+			if (int cost = cur[ASCII].cost; cost != std::numeric_limits<int>::max()) {
+				for (int s : {C40_0, TEXT_0, X12_0, EDF_0})
+					relax(pos, s, pos, ASCII, cost + 1);
+
+				if (pos + 1 < end && IsDigit(c) && IsDigit(msg[pos + 1]))
+					relax(pos + 2, ASCII, pos, ASCII, cost + 1);
+				relax(pos + 1, ASCII, pos, ASCII, cost + 1 + IsExtendedASCII(c));
+
+				for (int len = 1; len <= std::min(1555, end - pos); ++len)
+					relax(pos + len, ASCII, pos, B256, cost + 1 + (len <= 249 ? 1 : 2) + len);
+			}
+
+			for (int s : {C40_0, TEXT_0}) {
+				values.clear();
+				int m = EncodeC40Char(s, c, values);
+				for (int r = 0; r < 3; ++r)
+					if (int cost = cur[s + r].cost; cost != std::numeric_limits<int>::max())
+						relax(pos + 1, s + (r + m) % 3, pos, s + r, cost + 2 * ((r + m) / 3));
+			}
+
+			if (IsNativeX12(c))
+				for (int r = 0; r < 3; ++r)
+					if (int cost = cur[X12_0 + r].cost; cost != std::numeric_limits<int>::max())
+						relax(pos + 1, X12_0 + (r + 1) % 3, pos, X12_0 + r, cost + 2 * (r == 2));
+
+			if (IsNativeEDIFACT(c))
+				for (int r = 0; r < 4; ++r)
+					if (int cost = cur[EDF_0 + r].cost; cost != std::numeric_limits<int>::max())
+						relax(pos + 1, EDF_0 + (r + 1) % 4, pos, EDF_0 + r, cost + (r < 3));
+		}
+
+		// Greedy ASCII encoding of the few characters that may follow an implicit unlatch at the end of the symbol
+		auto asciiStep = [&](int pos) { return pos + 1 < end && IsDigit(msg[pos]) && IsDigit(msg[pos + 1]) ? 2 : 1; };
+		auto asciiCost = [&](int pos) {
+			int cost = 0;
+			for (; pos < end; pos += asciiStep(pos))
+				cost += 1 + IsExtendedASCII(msg[pos] & 0xff);
+			return cost;
+		};
+
+		// Pick the end resulting in the smallest symbol. The decoder leaves C40/Text/X12 (EDIFACT) implicitly if less than
+		// 2 (3) codewords are left, so if the symbol is (nearly) full after a complete triplet (group) the unlatch is
+		// omitted and the last characters may follow in ASCII. Two remaining C40/Text values are padded with a Shift 1.
+		// An EDIFACT unlatch needs room for the complete group in the symbol, see DecodeEdifactSegment.
+		struct { int pos = -1, state = -1, capacity = std::numeric_limits<int>::max(); bool unlatch = false; } best;
+		auto consider = [&](int pos, int state, int len, int maxCapacity, bool unlatch) {
+			auto symbolInfo = context.lookupSymbolInfo(len);
+			if (symbolInfo && symbolInfo->dataCapacity() <= maxCapacity && symbolInfo->dataCapacity() < best.capacity)
+				best = {pos, state, symbolInfo->dataCapacity(), unlatch};
+		};
+		const int noLimit = std::numeric_limits<int>::max();
+		for (int pos = std::max(start, end - 4); pos <= end; ++pos)
+			for (int s : {C40_0, TEXT_0, X12_0, EDF_0})
+				if (int cost = node(pos, s).cost, slack = s == EDF_0 ? 2 : 1; cost != noLimit && asciiCost(pos) <= slack)
+					consider(pos, s, cost + asciiCost(pos), cost + slack, false);
+		for (int s = 0; s < NUM_STATES; ++s) {
+			int cost = nodes.back()[s].cost;
+			if (cost == noLimit)
+				continue;
+			switch (Encodation(s)) {
+			case ASCII_ENCODATION: consider(end, s, cost, noLimit, false); break;
+			case EDIFACT_ENCODATION:
+				if (int r = s - EDF_0; r > 0)
+					consider(end, s, std::max(cost + (r < 3), cost - r + 3), noLimit, true);
+				break;
+			default:
+				int r = (s - C40_0) % 3;
+				if (r == 1 || (r == 2 && Encodation(s) == X12_ENCODATION))
+					continue;
+				if (r == 2)
+					consider(end, s, cost + 2, cost + 3, false);
+				consider(end, s, cost + r + 1, noLimit, true);
+			}
+		}
+		if (best.state == -1)
+			throw std::invalid_argument("Can't find a symbol arrangement that matches the message.");
+
+		std::vector<std::pair<int, int>> path; // (pos, state) with B256 marking the ASCII node after a Base 256 segment
+		for (int pos = best.pos, state = best.state; pos != -1;) {
+			auto& n = node(pos, state);
+			path.emplace_back(pos, state);
+			if (n.prevState == B256)
+				path.back().second = B256;
+			state = n.prevState == B256 ? int(ASCII) : n.prevState;
+			pos = n.prevPos;
+		}
+		std::reverse(path.begin(), path.end());
+
+		auto addASCII = [&](int pos, int len) {
+			int c = msg[pos] & 0xff;
+			if (len == 2) {
+				context.addCodeword(ASCIIEncoder::EncodeASCIIDigits(c, msg[pos + 1]));
+			} else if (IsExtendedASCII(c)) {
+				context.addCodeword(UPPER_SHIFT);
+				context.addCodeword(static_cast<uint8_t>(c - 128 + 1));
+			} else {
+				context.addCodeword(static_cast<uint8_t>(c + 1));
+			}
+		};
+
+		int lastEdifactGroup = -1;
+		auto addEdifactValues = [&](std::string& buffer, bool flush) {
+			if (Size(buffer) == 4 || (flush && !buffer.empty())) {
+				for (uint8_t cw : EdifactEncoder::EncodeToCodewords(buffer, 0))
+					context.addCodeword(cw);
+				buffer.clear();
+			}
+		};
+
+		values.clear();
+		for (int i = 1; i < Size(path); ++i) {
+			auto [prevPos, prevState] = path[i - 1];
+			auto [pos, state] = path[i];
+			prevState = prevState == B256 ? ASCII : prevState;
+			if (state == B256) {
+				int len = pos - prevPos;
+				context.addCodeword(LATCHES[BASE256_ENCODATION]);
+				auto addRandomized = [&](int c) { context.addCodeword(Base256Encoder::Randomize255State(c, context.codewordCount() + 1)); };
+				if (len <= 249) {
+					addRandomized(len);
+				} else {
+					addRandomized(len / 250 + 249);
+					addRandomized(len % 250);
+				}
+				for (int p = prevPos; p < pos; ++p)
+					addRandomized(msg[p] & 0xff);
+			} else if (pos == prevPos) {
+				if (state != ASCII) { // latch
+					context.addCodeword(LATCHES[Encodation(state)]);
+				} else if (Encodation(prevState) == EDIFACT_ENCODATION) {
+					if (values.empty())
+						lastEdifactGroup = context.codewordCount();
+					values.push_back(31); // unlatch
+					addEdifactValues(values, true);
+				} else {
+					context.addCodeword(C40_UNLATCH);
+				}
+			} else if (state == ASCII) {
+				addASCII(prevPos, pos - prevPos);
+			} else {
+				int c = msg[prevPos] & 0xff;
+				switch (Encodation(state)) {
+				case EDIFACT_ENCODATION:
+					if (values.empty())
+						lastEdifactGroup = context.codewordCount();
+					EdifactEncoder::EncodeChar(c, values);
+					addEdifactValues(values, false);
+					break;
+				case X12_ENCODATION: X12Encoder::EncodeChar(c, values); break;
+				default: EncodeC40Char(state, c, values);
+				}
+				while (Size(values) >= 3 && Encodation(state) != EDIFACT_ENCODATION)
+					C40Encoder::WriteNextTriplet(context, values);
+			}
+		}
+
+		switch (Encodation(best.state)) {
+		case ASCII_ENCODATION: break;
+		case EDIFACT_ENCODATION:
+			if (best.unlatch) {
+				if (values.empty())
+					lastEdifactGroup = context.codewordCount();
+				values.push_back(31);
+				addEdifactValues(values, true);
+			}
+			break;
+		default:
+			if (!values.empty()) {
+				values.push_back('\0'); // Shift 1 as pad
+				C40Encoder::WriteNextTriplet(context, values);
+			}
+			if (best.unlatch)
+				context.addCodeword(C40_UNLATCH);
+		}
+		for (int pos = best.pos; pos < end; pos += asciiStep(pos))
+			addASCII(pos, asciiStep(pos));
+
+		// the decoder reads EDIFACT only in complete groups of 3 codewords, so the symbol has to have room for that
+		context.updateSymbolInfo(std::max(context.codewordCount(), lastEdifactGroup + 3));
+	}
+
+} // MinimalEncoder
+
 //TODO: c++20
 static bool StartsWith(std::wstring_view s, std::wstring_view ss)
 {
@@ -865,9 +1124,11 @@ ByteArray Encode(const std::wstring& msg)
 *                {@code SymbolShapeHint.FORCE_SQUARE} or {@code SymbolShapeHint.FORCE_RECTANGLE}.
 * @param minSize the minimum symbol size constraint or null for no constraint
 * @param maxSize the maximum symbol size constraint or null for no constraint
+* @param minimal use the shortest path search of MinimalEncoder instead of the look-ahead heuristic of annex P
 * @return the encoded message (the char values range from 0 to 255)
 */
-ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
+ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight,
+				 bool minimal)
 {
 	//the codewords 0..255 are encoded as Unicode characters
 	//Encoder[] encoders = {
@@ -899,7 +1160,9 @@ ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shap
 	}
 
 	int encodingMode = ASCII_ENCODATION; //Default mode
-	while (context.hasMoreCharacters()) {
+	if (minimal)
+		MinimalEncoder::EncodeMinimal(context);
+	while (!minimal && context.hasMoreCharacters()) {
 		switch (encodingMode) {
 		case ASCII_ENCODATION:   ASCIIEncoder::EncodeASCII(context);     break;
 		case C40_ENCODATION:     C40Encoder::EncodeC40(context);         break;
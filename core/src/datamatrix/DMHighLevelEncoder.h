@@ -23,7 +23,8 @@ enum class SymbolShape;
 * annex S.
 */
 ByteArray Encode(const std::wstring& msg);
-ByteArray Encode(const std::wstring& msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight);
+ByteArray Encode(const std::wstring& msg, CharacterSet encoding, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight,
+				 bool minimal = false);
 
 } // DataMatrix
 } // ZXing
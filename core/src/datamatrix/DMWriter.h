@@ -49,6 +49,11 @@ public:
 		return *this;
 	}
 
+	Writer& setMinimalEncoding(bool minimal) {
+		_minimalEncoding = minimal;
+		return *this;
+	}
+
 	BitMatrix encode(const std::wstring& contents, int width, int height) const;
 	BitMatrix encode(const std::string& contents, int width, int height) const;
 
@@ -56,6 +61,7 @@ private:
 	SymbolShape _shapeHint;
 	int _quietZone = 1, _minWidth = -1, _minHeight = -1, _maxWidth = -1, _maxHeight = -1;
 	CharacterSet _encoding;
+	bool _minimalEncoding = false;
 };
 
 } // DataMatrix
@@ -8,12 +8,15 @@
 
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "ZXAlgorithms.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 
 namespace ZXing::MaxiCode {
 
-static const std::array<std::array<int, BitMatrixParser::MATRIX_WIDTH>, BitMatrixParser::MATRIX_HEIGHT> BITNR = {
+static constexpr std::array<std::array<int, BitMatrixParser::MATRIX_WIDTH>, BitMatrixParser::MATRIX_HEIGHT> BITNR = {
 	121,120,127,126,133,132,139,138,145,144,151,150,157,156,163,162,169,168,175,174,181,180,187,186,193,192,199,198, -2, -2,
 	123,122,129,128,135,134,141,140,147,146,153,152,159,158,165,164,171,170,177,176,183,182,189,188,195,194,201,200,816, -3,
 	125,124,131,130,137,136,143,142,149,148,155,154,161,160,167,166,173,172,179,178,185,184,191,190,197,196,203,202,818,817,
@@ -49,19 +52,26 @@ static const std::array<std::array<int, BitMatrixParser::MATRIX_WIDTH>, BitMatri
 	737,736,743,742,749,748,755,754,761,760,767,766,773,772,779,778,785,784,791,790,797,796,803,802,809,808,815,814,863,862,
 };
 
+// inverse of BITNR, computed at compile time
+static constexpr auto CODEWORD_MODULES = [] {
+	std::array<std::array<uint8_t, 2>, 144 * 6> res = {};
+	for (int y = 0; y < BitMatrixParser::MATRIX_HEIGHT; ++y)
+		for (int x = 0; x < BitMatrixParser::MATRIX_WIDTH; ++x)
+			if (int bit = BITNR[y][x]; bit >= 0)
+				res[bit] = {static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+	return res;
+}();
+
+const std::array<std::array<uint8_t, 2>, 144 * 6>& BitMatrixParser::CodewordModules()
+{
+	return CODEWORD_MODULES;
+}
+
 ByteArray BitMatrixParser::ReadCodewords(const BitMatrix& image)
 {
-	ByteArray result(144);
-	int height = image.height();
-	int width = image.width();
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			int bit = BITNR[y][x];
-			if (bit >= 0 && image.get(x, y)) {
-				result[bit / 6] |= static_cast<uint8_t>(1 << (5 - (bit % 6)));
-			}
-		}
-	}
+	auto codewords = ReadCodewords([&image](int x, int y) { return image.get(x, y); });
+	ByteArray result(Size(codewords));
+	std::copy(codewords.begin(), codewords.end(), result.begin());
 	return result;
 }
 
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace ZXing {
 
 class ByteArray;
@@ -13,6 +16,8 @@ class BitMatrix;
 
 namespace MaxiCode {
 
+using Codewords = std::array<uint8_t, 144>;
+
 /**
 * @author mike32767
 * @author Manuel Kasten
@@ -22,6 +27,27 @@ class BitMatrixParser
 public:
 	static ByteArray ReadCodewords(const BitMatrix& image);
 
+	/**
+	 * Gathers the codewords straight from the sampled symbol without an intermediate BitMatrix.
+	 * isBlack(x, y) is called exactly once for each of the 864 data modules.
+	 */
+	template <typename F>
+	static Codewords ReadCodewords(F isBlack)
+	{
+		Codewords res;
+		const auto* module = CodewordModules().data();
+		for (auto& codeword : res) {
+			int bits = 0;
+			for (int i = 0; i < 6; ++i, ++module)
+				bits = (bits << 1) | static_cast<int>(isBlack((*module)[0], (*module)[1]));
+			codeword = static_cast<uint8_t>(bits);
+		}
+		return res;
+	}
+
+	/// (x, y) of the module holding each codeword bit, most significant bit first
+	static const std::array<std::array<uint8_t, 2>, 144 * 6>& CodewordModules();
+
 	static const int MATRIX_WIDTH = 30;
 	static const int MATRIX_HEIGHT = 33;
 };
@@ -6,6 +6,7 @@
 
 #include "MCDecoder.h"
 
+#include "BitMatrix.h"
 #include "ByteArray.h"
 #include "CharacterSet.h"
 #include "DecoderResult.h"
@@ -27,7 +28,7 @@ static const int ALL = 0;
 static const int EVEN = 1;
 static const int ODD = 2;
 
-static bool CorrectErrors(ByteArray& codewordBytes, int start, int dataCodewords, int ecCodewords, int mode)
+static bool CorrectErrors(Codewords& codewordBytes, int start, int dataCodewords, int ecCodewords, int mode)
 {
 	int codewords = dataCodewords + ecCodewords;
 
@@ -295,10 +296,8 @@ DecoderResult Decode(ByteArray&& bytes, const int mode)
 
 } // DecodedBitStreamParser
 
-DecoderResult Decode(const BitMatrix& bits)
+DecoderResult Decode(Codewords codewords)
 {
-	ByteArray codewords = BitMatrixParser::ReadCodewords(bits);
-
 	if (!CorrectErrors(codewords, 0, 10, 10, ALL))
 		return ChecksumError();
 
@@ -329,4 +328,9 @@ DecoderResult Decode(const BitMatrix& bits)
 	return DecodedBitStreamParser::Decode(std::move(datawords), mode);
 }
 
+DecoderResult Decode(const BitMatrix& bits)
+{
+	return Decode(BitMatrixParser::ReadCodewords([&bits](int x, int y) { return bits.get(x, y); }));
+}
+
 } // namespace ZXing::MaxiCode
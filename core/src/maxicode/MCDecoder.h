@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "MCBitMatrixParser.h"
+
 namespace ZXing {
 
 class DecoderResult;
@@ -14,6 +16,7 @@ class BitMatrix;
 namespace MaxiCode {
 
 DecoderResult Decode(const BitMatrix& bits);
+DecoderResult Decode(Codewords codewords);
 
 } // MaxiCode
 } // ZXing
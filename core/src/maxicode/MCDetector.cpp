@@ -0,0 +1,380 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MCDetector.h"
+
+#include "BitMatrix.h"
+#include "BitMatrixCursor.h"
+#include "ConcentricFinder.h"
+#include "MCBitMatrixParser.h"
+#include "Pattern.h"
+#include "PerspectiveTransform.h"
+#include "ZXAlgorithms.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace ZXing::MaxiCode {
+
+// All geometry below is expressed in 'symbol space', where the unit is the nominal module width X, the x-axis runs
+// along the rows and the y-axis points down. The modules are hexagons, odd rows are shifted right by half a module.
+constexpr int WIDTH = BitMatrixParser::MATRIX_WIDTH;
+constexpr int HEIGHT = BitMatrixParser::MATRIX_HEIGHT;
+constexpr double ROW_PITCH = 0.8660254; // sqrt(3) / 2
+constexpr double ROW_OFFSET = 0.5773503; // 1 / sqrt(3), distance from the top of the symbol to the center of row 0
+constexpr double SYMBOL_HEIGHT = (HEIGHT - 1) * ROW_PITCH + 2 * ROW_OFFSET;
+constexpr auto std_numbers_pi_v = 3.14159265358979323846; // TODO: c++20 <numbers>
+
+// The bullseye consists of a light center disc and 3 dark rings. The rings and the light gaps in between are all
+// RING_WIDTH wide. Data modules may touch the outer ring, so the pattern only covers the inner 2 rings.
+constexpr double RING_WIDTH = 0.785;
+constexpr auto PATTERN = FixedPattern<9, 19>{2, 2, 2, 2, 3, 2, 2, 2, 2};
+constexpr bool E2E = true;
+
+static PointF ModuleCenter(int x, int y)
+{
+	return {x + 0.5 + 0.5 * (y & 1), y * ROW_PITCH + ROW_OFFSET};
+}
+
+static const PointF BULLSEYE_CENTER = ModuleCenter(14, 16);
+
+struct OrientationModule
+{
+	int x, y;
+	bool black;
+};
+
+// ISO/IEC 16023:2000 Figure 6: 3 modules in each of 6 clusters around the bullseye, see also BITNR (-1, -2)
+static constexpr OrientationModule ORIENTATION_MODULES[] = {
+	{10, 9, true},  {11, 9, true},  {11, 10, true}, {17, 9, false},  {17, 10, false}, {18, 10, false},
+	{7, 15, true},  {7, 16, false}, {8, 16, true},  {20, 16, true},  {21, 16, false}, {20, 17, true},
+	{10, 22, true}, {11, 22, false}, {10, 23, true}, {17, 22, true},  {16, 23, false}, {17, 23, true},
+};
+
+/**
+ * Affine mapping from symbol space into the image, anchored at the bullseye center.
+ */
+struct Grid
+{
+	PointF center, ax, ay; // image location of the bullseye center and image vectors of the symbol space unit vectors
+
+	PointF operator()(PointF s) const
+	{
+		auto d = s - BULLSEYE_CENTER;
+		return center + d.x * ax + d.y * ay;
+	}
+};
+
+static PatternView FindBullseyePattern(const PatternView& view)
+{
+	return FindLeftGuard<PATTERN.size()>(view, PATTERN.size(), [](const PatternView& view, int spaceInPixel) {
+		return IsPattern<E2E>(view, PATTERN, spaceInPixel);
+	});
+}
+
+static std::optional<ConcentricPattern> LocateBullseye(const BitMatrix& image, PointF p, int range)
+{
+	auto cur = BitMatrixCursorI(image, PointI(p), {});
+	int minSpread = image.width(), maxSpread = 0;
+	for (auto d : {PointI{0, 1}, {1, 0}, {1, 1}, {1, -1}}) {
+		int spread = CheckSymmetricPattern<E2E>(cur.setDirection(d), PATTERN, range, !(d.x && d.y));
+		if (!spread)
+			return {};
+		UpdateMinMax(minSpread, maxSpread, spread);
+	}
+
+	if (maxSpread > 3 * minSpread)
+		return {};
+
+	// contrary to the QRCode and Aztec finder patterns, the center is light -> average the centers of the 3 dark rings
+	PointF sum = {};
+	for (int nth : {1, 3, 5}) {
+		auto c = CenterOfRing(image, cur.p, range, nth);
+		if (!c)
+			return {};
+		sum += *c;
+	}
+	auto center = sum / 3;
+	if (!image.isIn(center) || image.get(center))
+		return {};
+
+	return ConcentricPattern{center, (maxSpread + minSpread) / 2};
+}
+
+constexpr int NUM_RAYS = 64;
+using RingEdges = std::array<double, 5>; // distances of the first 5 edges from the bullseye center along a ray
+using Rays = std::array<std::optional<RingEdges>, NUM_RAYS>;
+
+static PointF RayDirection(int i)
+{
+	double a = 2 * std_numbers_pi_v * i / NUM_RAYS;
+	return {std::cos(a), std::sin(a)};
+}
+
+static Rays MeasureRays(const BitMatrix& image, PointF center, int range)
+{
+	// walk the rays in quarter pixel steps, so the quantization errors of the edge positions vary from ray to ray
+	constexpr double STEP = 0.25;
+	Rays res;
+	for (int i = 0; i < NUM_RAYS; ++i) {
+		auto d = STEP * RayDirection(i);
+		auto p = center;
+		bool last = image.get(p);
+		RingEdges edges;
+		int e = 0;
+		for (int s = 1; s <= range / STEP && e < Size(edges); ++s) {
+			p += d;
+			if (!image.isIn(p))
+				break;
+			if (image.get(p) != last) {
+				last = !last;
+				edges[e++] = (s - 0.5) * STEP;
+			}
+		}
+		if (e == Size(edges))
+			res[i] = edges;
+	}
+	return res;
+}
+
+static std::optional<Grid> EstimateGrid(const BitMatrix& image, const ConcentricPattern& bullseye)
+{
+	PointF center = bullseye;
+	int range = bullseye.size;
+
+	// the center is the mid point between the ring edges on opposing rays (this holds under affine distortion, too)
+	auto rays = MeasureRays(image, center, range);
+	double sxx = 0, sxy = 0, syy = 0;
+	PointF sd = {};
+	for (int i = 0; i < NUM_RAYS / 2; ++i) {
+		auto &a = rays[i], &b = rays[i + NUM_RAYS / 2];
+		if (!a || !b)
+			continue;
+		double d = 0;
+		for (int e = 0; e < Size(*a); ++e)
+			d += ((*a)[e] - (*b)[e]) / (2 * Size(*a));
+		auto u = RayDirection(i);
+		sxx += u.x * u.x, sxy += u.x * u.y, syy += u.y * u.y;
+		sd += d * u; // the rays pointing towards the true center are the longer ones
+	}
+	if (double det = sxx * syy - sxy * sxy; det > NUM_RAYS / 32.) {
+		center += PointF(syy * sd.x - sxy * sd.y, sxx * sd.y - sxy * sd.x) / det;
+		rays = MeasureRays(image, center, range);
+	}
+
+	// The unit circle in symbol space is mapped to an ellipse in the image. Its 'radius' r along the direction (x, y)
+	// fulfills 1/r² = m00 * x² + 2 * m01 * x * y + m11 * y². Fit M to the ring spacing (same-polarity edge pairs
+	// only, which makes this independent of the binarization threshold) with linear least squares.
+	std::array<std::array<double, 4>, 3> ne = {}; // normal equations, 4th column is the right hand side
+	int n = 0;
+	for (int i = 0; i < NUM_RAYS; ++i) {
+		if (!rays[i])
+			continue;
+		auto& t = *rays[i];
+		double r = ((t[4] - t[0]) + (t[3] - t[1])) / (6 * RING_WIDTH);
+		auto u = RayDirection(i);
+		std::array<double, 4> f = {u.x * u.x, 2 * u.x * u.y, u.y * u.y, 1 / (r * r)};
+		for (int j = 0; j < 3; ++j)
+			for (int k = 0; k < 4; ++k)
+				ne[j][k] += f[j] * f[k];
+		++n;
+	}
+	if (n < NUM_RAYS * 3 / 4)
+		return {};
+
+	auto det3 = [&ne](int c) {
+		auto col = [&](int r, int j) { return ne[r][j == c ? 3 : j]; };
+		return col(0, 0) * (col(1, 1) * col(2, 2) - col(1, 2) * col(2, 1)) -
+			   col(0, 1) * (col(1, 0) * col(2, 2) - col(1, 2) * col(2, 0)) +
+			   col(0, 2) * (col(1, 0) * col(2, 1) - col(1, 1) * col(2, 0));
+	};
+	double det = det3(-1);
+	if (std::abs(det) < 1e-12)
+		return {};
+	double m00 = det3(0) / det, m01 = det3(1) / det, m11 = det3(2) / det;
+
+	// S = M^(-1/2) maps the unit circle onto the ellipse, the symbol to image mapping is S * R(alpha)
+	double mean = (m00 + m11) / 2, dev = std::sqrt((m00 - m11) * (m00 - m11) / 4 + m01 * m01);
+	double l1 = mean + dev, l2 = mean - dev;
+	if (l2 <= 0 || l1 > 16 * l2) // reject highly skewed ellipses (aspect ratio > 4)
+		return {};
+	double phi = std::atan2(2 * m01, m00 - m11) / 2, c = std::cos(phi), s = std::sin(phi);
+	double s1 = 1 / std::sqrt(l1), s2 = 1 / std::sqrt(l2);
+	auto S = [&](PointF v) {
+		double a = c * v.x + s * v.y, b = -s * v.x + c * v.y;
+		return PointF(c * s1 * a - s * s2 * b, s * s1 * a + c * s2 * b);
+	};
+
+	auto gridAt = [&](double alpha) {
+		auto ca = std::cos(alpha), sa = std::sin(alpha);
+		return Grid{center, S({ca, sa}), S({-sa, ca})};
+	};
+
+	auto orientationScore = [&](const Grid& grid) {
+		int score = 0;
+		for (auto [x, y, black] : ORIENTATION_MODULES) {
+			auto p = grid(ModuleCenter(x, y));
+			score += image.isIn(p) && image.get(p) == black;
+		}
+		return score;
+	};
+
+	// find the rotation by matching the orientation modules in 1 degree steps and pick the center of the widest plateau
+	std::array<int, 360> scores;
+	for (int a = 0; a < Size(scores); ++a)
+		scores[a] = orientationScore(gridAt(a * std_numbers_pi_v / 180));
+
+	int maxScore = *std::max_element(scores.begin(), scores.end());
+	if (maxScore < Size(ORIENTATION_MODULES) - 1)
+		return {};
+
+	int bestStart = 0, bestLen = 0;
+	for (int a = 0; a < Size(scores); ++a) {
+		if (scores[a] != maxScore || scores[(a + Size(scores) - 1) % Size(scores)] == maxScore)
+			continue;
+		int len = 1;
+		while (len < Size(scores) && scores[(a + len) % Size(scores)] == maxScore)
+			++len;
+		if (len > bestLen)
+			bestStart = a, bestLen = len;
+	}
+	if (bestLen == 0) // all angles match equally well -> no orientation information at all
+		return {};
+
+	return gridAt((bestStart + (bestLen - 1) / 2.) * std_numbers_pi_v / 180);
+}
+
+/**
+ * Counts how many sample points around each module center agree with the value at the center. This is maximal if the
+ * grid is aligned with the modules and decreases as soon as the samples start to cross module boundaries.
+ */
+static int GridConsistency(const BitMatrix& image, const Grid& grid)
+{
+	// 1/3 of the way to the 6 neighbouring modules
+	static const PointF offsets[] = {{1. / 3, 0}, {-1. / 3, 0}, {1. / 6, ROW_PITCH / 3}, {-1. / 6, ROW_PITCH / 3},
+									 {1. / 6, -ROW_PITCH / 3}, {-1. / 6, -ROW_PITCH / 3}};
+	int score = 0;
+	for (int y = 0; y < HEIGHT; ++y)
+		for (int x = 0; x < WIDTH; ++x) {
+			auto m = ModuleCenter(x, y);
+			if (distance(m, BULLSEYE_CENTER) < 5) // the rings do not line up with the module grid
+				continue;
+			auto c = grid(m);
+			if (!image.isIn(c))
+				continue;
+			bool v = image.get(c);
+			for (auto o : offsets)
+				if (auto p = grid(m + o); image.isIn(p) && image.get(p) == v)
+					++score;
+		}
+	return score;
+}
+
+template <typename F>
+static double CenterOfBestScore(double range, double step, F score)
+{
+	int best = -1, n = 0;
+	double sum = 0;
+	for (double v = -range; v <= range + step / 2; v += step) {
+		int s = score(v);
+		if (s > best)
+			best = s, sum = v, n = 1;
+		else if (s == best)
+			sum += v, ++n;
+	}
+	return sum / n;
+}
+
+/**
+ * The rotation is only known up to the size of the orientation modules and the scale only as precise as the ring
+ * measurements. Both errors accumulate towards the border of the symbol, so fine tune the mapping by looking at all
+ * modules: rotation, scale along both symbol axes and shear, which together cover any residual linear distortion.
+ */
+static Grid RefineGrid(const BitMatrix& image, Grid grid)
+{
+	// returns the grid with the symbol space transformed by (b00, b01; b10, b11) before being mapped into the image
+	auto transformed = [](const Grid& g, double b00, double b01, double b10, double b11) {
+		return Grid{g.center, b00 * g.ax + b10 * g.ay, b01 * g.ax + b11 * g.ay};
+	};
+	auto rotated = [&](const Grid& g, double deg) {
+		double a = deg * std_numbers_pi_v / 180, c = std::cos(a), s = std::sin(a);
+		return transformed(g, c, -s, s, c);
+	};
+	auto scaledX = [&](const Grid& g, double d) { return transformed(g, 1 + d, 0, 0, 1); };
+	auto scaledY = [&](const Grid& g, double d) { return transformed(g, 1, 0, 0, 1 + d); };
+	auto sheared = [&](const Grid& g, double d) { return transformed(g, 1, d, 0, 1); };
+
+	auto optimize = [&](auto op, double range, double step) {
+		grid = op(grid, CenterOfBestScore(range, step, [&](double d) { return GridConsistency(image, op(grid, d)); }));
+	};
+
+	for (int i = 0; i < 2; ++i) {
+		optimize(rotated, 2, 0.25);
+		optimize(scaledX, 0.04, 0.005);
+		optimize(scaledY, 0.04, 0.005);
+		optimize(sheared, 0.04, 0.005);
+	}
+	return grid;
+}
+
+static std::optional<DetectedSymbol> ToDetectedSymbol(const Grid& grid)
+{
+	auto symbol = QuadrilateralF{PointF{0, 0}, {WIDTH, 0}, {WIDTH, SYMBOL_HEIGHT}, {0, SYMBOL_HEIGHT}};
+	QuadrilateralF position;
+	for (int i = 0; i < 4; ++i)
+		position[i] = grid(symbol[i]);
+
+	auto mod2Pix = PerspectiveTransform(symbol, position);
+	if (!mod2Pix.isValid())
+		return {};
+
+	return DetectedSymbol{mod2Pix, {position[0], position[1], position[2], position[3]}};
+}
+
+PointF DetectedSymbol::moduleCenter(int x, int y) const
+{
+	return mod2Pix(ModuleCenter(x, y));
+}
+
+std::vector<DetectedSymbol> Detect(const BitMatrix& image, bool tryHarder)
+{
+	// a scan line has to pass through the light center disc (about 1.15 modules in diameter) to see the full pattern
+	const int skip = tryHarder ? 1 : 2;
+
+	std::vector<DetectedSymbol> res;
+	std::vector<ConcentricPattern> bullseyes;
+	PatternRow row;
+
+	for (int y = 0; y < image.height(); y += skip) {
+		GetPatternRow(image, y, row, false);
+		PatternView next = row;
+		next.shift(1); // the pattern starts with the light gap between the 2nd and the 3rd ring
+
+		while (next = FindBullseyePattern(next), next.isValid()) {
+			PointF p(next.pixelsInFront() + next.sum(PATTERN.size() / 2) + next[PATTERN.size() / 2] / 2.0, y + 0.5);
+
+			// make sure p is not 'inside' an already found pattern area
+			if (!IsInsideFoundPattern(bullseyes, p)) {
+				if (auto bullseye = LocateBullseye(image, p, next.sum() * 2)) {
+					bullseyes.push_back(*bullseye);
+					if (auto grid = EstimateGrid(image, *bullseye)) {
+						if (auto symbol = ToDetectedSymbol(RefineGrid(image, *grid)))
+							res.push_back(*symbol);
+					}
+				}
+			}
+
+			next.skipPair();
+			next.extend();
+		}
+	}
+
+	return res;
+}
+
+} // namespace ZXing::MaxiCode
@@ -0,0 +1,40 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PerspectiveTransform.h"
+#include "Quadrilateral.h"
+
+#include <vector>
+
+namespace ZXing {
+class BitMatrix;
+}
+
+namespace ZXing::MaxiCode {
+
+/**
+ * A MaxiCode symbol located in the image. Sampling happens on demand via moduleCenter(), which lets the codewords be
+ * gathered directly from the image (see BitMatrixParser::ReadCodewords).
+ */
+struct DetectedSymbol
+{
+	PerspectiveTransform mod2Pix; // maps the symbol space (unit is the module width, y pointing down) into the image
+	QuadrilateralI position;
+
+	/// image location of module (x, y) in the layout of BitMatrixParser (30x33, odd rows shifted by half a module)
+	PointF moduleCenter(int x, int y) const;
+};
+
+/**
+ * @brief Detect locates MaxiCode symbols by their bullseye finder pattern.
+ *
+ * Only symbols whose orientation modules could be matched are returned. The number is not limited, because a located
+ * symbol may still fail to decode: limiting the number of decoded symbols is up to the caller.
+ */
+std::vector<DetectedSymbol> Detect(const BitMatrix& image, bool tryHarder);
+
+} // namespace ZXing::MaxiCode
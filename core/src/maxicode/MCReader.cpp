@@ -12,55 +12,94 @@
 #include "DetectorResult.h"
 #include "MCBitMatrixParser.h"
 #include "MCDecoder.h"
+#include "MCDetector.h"
 #include "Barcode.h"
+#include "ZXAlgorithms.h"
+
+#include <utility>
 
 namespace ZXing::MaxiCode {
 
+/**
+* Wraps the position into a DetectorResult. The sampled symbol is only materialized as a BitMatrix when it can be
+* retrieved via Barcode::symbol(), the codewords are gathered straight from the image.
+*/
+template <typename F>
+static DetectorResult MakeDetectorResult([[maybe_unused]] F isBlack, QuadrilateralI&& position)
+{
+#ifdef ZXING_EXPERIMENTAL_API
+	BitMatrix bits(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
+	for (int y = 0; y < bits.height(); y++)
+		for (int x = 0; x < bits.width(); x++)
+			if (isBlack(x, y))
+				bits.set(x, y);
+	return {std::move(bits), std::move(position)};
+#else
+	return {{}, std::move(position)};
+#endif
+}
+
 /**
 * This method detects a code in a "pure" image -- that is, pure monochrome image
 * which contains only an unrotated, unskewed, image of a code, with some white border
 * around it. This is a specialized method that works exceptionally fast in this special
 * case.
 */
-static BitMatrix ExtractPureBits(const BitMatrix& image)
+static Barcode DecodePure(const BitMatrix& image)
 {
 	int left, top, width, height;
 	if (!image.findBoundingBox(left, top, width, height, BitMatrixParser::MATRIX_WIDTH))
 		return {};
 
 	// Now just read off the bits
-	BitMatrix result(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
-	for (int y = 0; y < BitMatrixParser::MATRIX_HEIGHT; y++) {
+	auto isBlack = [&](int x, int y) {
 		int iy = top + (y * height + height / 2) / BitMatrixParser::MATRIX_HEIGHT;
-		for (int x = 0; x < BitMatrixParser::MATRIX_WIDTH; x++) {
-			int ix = left + (x * width + width / 2 + (y & 0x01) *  width / 2) / BitMatrixParser::MATRIX_WIDTH;
-			if (image.get(ix, iy)) {
-				result.set(x, y);
-			}
-		}
-	}
+		int ix = left + (x * width + width / 2 + (y & 0x01) *  width / 2) / BitMatrixParser::MATRIX_WIDTH;
+		return image.get(ix, iy);
+	};
+
+	DecoderResult decRes = Decode(BitMatrixParser::ReadCodewords(isBlack));
+	// TODO: before we can meaningfully return a ChecksumError result, we need to check the center for the presence of the finder pattern
+	if (!decRes.isValid())
+		return {};
 
 	//TODO: need to return position info
-	return result;
+	return Barcode(std::move(decRes), MakeDetectorResult(isBlack, {}), BarcodeFormat::MaxiCode);
 }
 
 Barcode Reader::decode(const BinaryBitmap& image) const
+{
+	return FirstOrDefault(decode(image, 1));
+}
+
+Barcodes Reader::decode(const BinaryBitmap& image, int maxSymbols) const
 {
 	auto binImg = image.getBitMatrix();
 	if (binImg == nullptr)
 		return {};
 
-	//TODO: this only works with effectively 'pure' barcodes. Needs proper detector.
-	BitMatrix bits = ExtractPureBits(*binImg);
-	if (bits.empty())
-		return {};
+	Barcodes res;
+	if (!_opts.isPure()) {
+		for (auto&& symbol : Detect(*binImg, _opts.tryHarder())) {
+			auto isBlack = [&](int x, int y) {
+				auto p = symbol.moduleCenter(x, y);
+				return binImg->isIn(p) && binImg->get(p);
+			};
+			auto decRes = Decode(BitMatrixParser::ReadCodewords(isBlack));
+			if (decRes.isValid(_opts.returnErrors())) {
+				res.emplace_back(std::move(decRes), MakeDetectorResult(isBlack, std::move(symbol.position)), BarcodeFormat::MaxiCode);
+				if (maxSymbols > 0 && Size(res) >= maxSymbols)
+					break;
+			}
+		}
+	}
 
-	DecoderResult decRes = Decode(bits);
-	// TODO: before we can meaningfully return a ChecksumError result, we need to check the center for the presence of the finder pattern
-	if (!decRes.isValid())
-		return {};
+	// fall back to the 'pure' code path, e.g. for tiny symbols where the bullseye is not resolved well enough
+	if (res.empty())
+		if (auto barcode = DecodePure(*binImg); barcode.isValid())
+			res.push_back(std::move(barcode));
 
-	return Barcode(std::move(decRes), DetectorResult{}, BarcodeFormat::MaxiCode);
+	return res;
 }
 
 } // namespace ZXing::MaxiCode
@@ -16,6 +16,7 @@ public:
 	using ZXing::Reader::Reader;
 
 	Barcode decode(const BinaryBitmap& image) const override;
+	Barcodes decode(const BinaryBitmap& image, int maxSymbols) const override;
 };
 
 } // namespace ZXing::MaxiCode
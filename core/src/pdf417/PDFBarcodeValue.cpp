@@ -17,31 +17,77 @@ namespace Pdf417 {
 void
 BarcodeValue::setValue(int value)
 {
-	_values[value] += 1;
+	for (int i = 0; i < _size; ++i)
+		if (_votes[i].value == value) {
+			_votes[i].count++;
+			return;
+		}
+	for (auto& v : _moreVotes)
+		if (v.value == value) {
+			v.count++;
+			return;
+		}
+	if (_size < INLINE_VOTES)
+		_votes[_size++] = {value, 1};
+	else
+		_moreVotes.push_back({value, 1});
+}
+
+int
+BarcodeValue::maxCount() const
+{
+	int res = 0;
+	forEach([&](const Vote& v) { res = std::max(res, v.count); });
+	return res;
+}
+
+int
+BarcodeValue::value() const
+{
+	int maxConfidence = maxCount();
+	int res = -1;
+	forEach([&](const Vote& v) {
+		if (v.count == maxConfidence && (res == -1 || v.value < res))
+			res = v.value;
+	});
+	return res;
+}
+
+bool
+BarcodeValue::isAmbiguous() const
+{
+	int maxConfidence = maxCount();
+	int n = 0;
+	forEach([&](const Vote& v) { n += v.count == maxConfidence; });
+	return n > 1;
 }
 
 /**
 * Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+* @return an array of int, containing the values with the highest occurrence in ascending order, or empty, if no value was set
 */
 std::vector<int>
-BarcodeValue::value() const
+BarcodeValue::values() const
 {
+	int maxConfidence = maxCount();
 	std::vector<int> result;
-	if (!_values.empty()) {
-		int maxConfidence = std::max_element(_values.begin(), _values.end(), [](auto& l, auto& r) { return l.second < r.second; })->second;
-		for (auto [value, count] : _values)
-			if (count == maxConfidence)
-				result.push_back(value);
-	}
+	forEach([&](const Vote& v) {
+		if (v.count == maxConfidence)
+			result.push_back(v.value);
+	});
+	std::sort(result.begin(), result.end());
 	return result;
 }
 
 int
 BarcodeValue::confidence(int value) const
 {
-	auto it = _values.find(value);
-	return it != _values.end() ? it->second : 0;
+	int res = 0;
+	forEach([&](const Vote& v) {
+		if (v.value == value)
+			res = v.count;
+	});
+	return res;
 }
 
 } // Pdf417
@@ -6,18 +6,43 @@
 
 #pragma once
 
-#include <map>
+#include <array>
+#include <cstdint>
 #include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
 
 /**
+* Vote counter for the values read at one position of the symbol. Almost all cells see only one or two different values,
+* so the first few are stored inline and only further ones spill to the heap.
+*
 * @author Guenther Grau
 */
 class BarcodeValue
 {
-	std::map<int, int> _values;
+	struct Vote
+	{
+		int value = 0;
+		int count = 0;
+	};
+
+	static constexpr int INLINE_VOTES = 3;
+
+	std::array<Vote, INLINE_VOTES> _votes;
+	std::vector<Vote> _moreVotes;
+	uint8_t _size = 0; // number of used entries in _votes
+
+	template <typename F>
+	void forEach(F f) const
+	{
+		for (int i = 0; i < _size; ++i)
+			f(_votes[i]);
+		for (auto& v : _moreVotes)
+			f(v);
+	}
+
+	int maxCount() const;
 
 public:
 	/**
@@ -25,11 +50,21 @@ public:
 	*/
 	void setValue(int value);
 
+	/**
+	* @return the value with the highest occurrence (the smallest one, if there are several) or -1 if no value was set
+	*/
+	int value() const;
+
+	/**
+	* @return true if more than one value was set with the highest occurrence
+	*/
+	bool isAmbiguous() const;
+
 	/**
 	* Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-	* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+	* @return an array of int, containing the values with the highest occurrence in ascending order, or empty, if no value was set
 	*/
-	std::vector<int> value() const;
+	std::vector<int> values() const;
 
 	int confidence(int value) const;
 };
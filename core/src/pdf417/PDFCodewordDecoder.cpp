@@ -12,6 +12,8 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <utility>
+#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -451,56 +453,119 @@ static constexpr int getSymbol(int idx)
 	return SYMBOL_TABLE[idx] | 0x10000;
 }
 
-static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
+/**
+* Index over the bar widths (in modules, 1..6) of all symbols, used to find the symbol closest to a set of measured bar
+* widths. The symbols are sorted by their widths and arranged in a trie with one level per pair of bars. The squared
+* error of a prefix is a lower bound for the error of all symbols below it, so whole subtrees are skipped as soon as
+* that bound exceeds the best match found so far, which leaves only a small fraction of the 2787 symbols to look at.
+*/
+class ClosestSymbolIndex
 {
-#if 1 // put 87kB on heap and calucate per process on first use -> 7% smaller binary
-	static const auto ratioTable = []() {
-		auto table = std::vector<std::array<float, CodewordDecoder::BARS_IN_MODULE>>(SYMBOL_COUNT);
-#else // put 87kB in .rodata shared by all processes and calcuate during compilation
-	static constexpr const auto ratioTable = []() constexpr {
-		auto table = std::array<std::array<float, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT>();
-#endif
+	static constexpr int N = CodewordDecoder::BARS_IN_MODULE;
+	static constexpr int LEVELS = N / 2;
+
+	struct Node
+	{
+		uint8_t w0, w1;      // widths of the bar pair of this level
+		uint16_t begin, end; // range of children in the next level, or index into SYMBOL_TABLE in the last level
+	};
+
+	std::array<std::vector<Node>, LEVELS> _levels;
+
+	template <int L>
+	void search(const std::array<std::array<float, 7>, N>& error, const Node& parent, float parentError, float& bestError,
+				int& best) const
+	{
+		for (int i = parent.begin; i < parent.end; ++i) {
+			auto& node = _levels[L][i];
+			float e = parentError + error[2 * L][node.w0] + error[2 * L + 1][node.w1];
+			if constexpr (L + 1 < LEVELS) {
+				if (e <= bestError)
+					search<L + 1>(error, node, e, bestError, best);
+			} else if (e < bestError || (e == bestError && node.begin < best)) {
+				bestError = e;
+				best = node.begin;
+			}
+		}
+	}
+
+public:
+	ClosestSymbolIndex()
+	{
+		std::vector<std::pair<std::array<uint8_t, N>, uint16_t>> symbols(SYMBOL_COUNT);
 		for (int i = 0; i < SYMBOL_COUNT; i++) {
 			int currentSymbol = getSymbol(i);
 			int currentBit = currentSymbol & 0x1;
-			for (int j = 0; j < CodewordDecoder::BARS_IN_MODULE; j++) {
-				int8_t size = 0;
+			for (int j = 0; j < N; j++) {
+				uint8_t size = 0;
 				while ((currentSymbol & 0x1) == currentBit) {
 					size += 1;
 					currentSymbol >>= 1;
 				}
 				currentBit = currentSymbol & 0x1;
-				table[i][CodewordDecoder::BARS_IN_MODULE - j - 1] = size / 17.f; // MODULES_IN_CODEWORD
+				symbols[i].first[N - j - 1] = size;
 			}
+			symbols[i].second = narrow_cast<uint16_t>(i);
 		}
-		return table;
-	}();
+		std::sort(symbols.begin(), symbols.end());
 
-	int bitCountSum = Reduce(moduleBitCount);
-	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios = {};
-	if (bitCountSum > 1) {
-		for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; i++) {
-			bitCountRatios[i] = moduleBitCount[i] / (float)bitCountSum;
+		for (auto& [w, index] : symbols) {
+			// a new node is needed on a level if its parent is new or its bar pair differs from the previous node
+			bool isNew = false;
+			for (int l = 0; l < LEVELS; ++l) {
+				auto& level = _levels[l];
+				isNew = isNew || level.empty() || level.back().w0 != w[2 * l] || level.back().w1 != w[2 * l + 1];
+				if (isNew)
+					level.push_back({w[2 * l], w[2 * l + 1], l + 1 < LEVELS ? narrow_cast<uint16_t>(_levels[l + 1].size()) : index, 0});
+			}
+			for (int l = 0; l < LEVELS - 1; ++l)
+				_levels[l].back().end = narrow_cast<uint16_t>(_levels[l + 1].size());
 		}
 	}
-	float bestMatchError = std::numeric_limits<float>::max();
-	int bestMatch = -1;
-	for (size_t j = 0; j < ratioTable.size(); j++) {
-		float error = 0.0f;
-		auto& ratioTableRow = ratioTable[j];
-		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
-			float diff = ratioTableRow[k] - bitCountRatios[k];
-			error += diff * diff;
-			if (error >= bestMatchError) {
-				break;
+
+	/**
+	* @return index of the symbol with the smallest squared error between its bar width ratios and the given ones.
+	* Ties are resolved in favor of the lower index, i.e. the result is identical to a linear scan over all symbols.
+	*/
+	int find(const std::array<float, N>& ratios) const
+	{
+		// error[k][w] is the squared error contribution of bar k if its width is w modules
+		std::array<std::array<float, 7>, N> error;
+		for (int k = 0; k < N; k++)
+			for (int w = 1; w <= 6; w++) {
+				float diff = w / 17.f - ratios[k]; // MODULES_IN_CODEWORD
+				error[k][w] = diff * diff;
 			}
-		}
-		if (error < bestMatchError) {
-			bestMatchError = error;
-			bestMatch = getSymbol(j);
+
+		// visit the first level in order of increasing error to get a tight bound early on
+		std::array<std::pair<float, int>, 36> order;
+		int n = Size(_levels[0]);
+		for (int i = 0; i < n; ++i)
+			order[i] = {error[0][_levels[0][i].w0] + error[1][_levels[0][i].w1], i};
+		std::sort(order.begin(), order.begin() + n);
+
+		float bestError = std::numeric_limits<float>::max();
+		int best = SYMBOL_COUNT;
+		for (int i = 0; i < n && order[i].first <= bestError; ++i)
+			search<1>(error, _levels[0][order[i].second], order[i].first, bestError, best);
+
+		return best;
+	}
+};
+
+int
+CodewordDecoder::GetClosestDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount)
+{
+	static const ClosestSymbolIndex index;
+
+	int bitCountSum = Reduce(moduleBitCount);
+	std::array<float, BARS_IN_MODULE> bitCountRatios = {};
+	if (bitCountSum > 1) {
+		for (int i = 0; i < BARS_IN_MODULE; i++) {
+			bitCountRatios[i] = moduleBitCount[i] / (float)bitCountSum;
 		}
 	}
-	return bestMatch;
+	return getSymbol(index.find(bitCountRatios));
 }
 
 int
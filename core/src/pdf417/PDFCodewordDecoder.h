@@ -33,6 +33,13 @@ public:
 	static int GetCodeword(int symbol);
 
 	static int GetDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount);
+
+	/**
+	* @param moduleBitCount measured widths of the 8 bars and spaces of a codeword
+	* @return the symbol with the smallest squared error between its bar width ratios and the measured ones (ties are
+	* resolved in favor of the lower symbol), used by GetDecodedValue if the sampled widths are not a valid symbol.
+	*/
+	static int GetClosestDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount);
 };
 
 } // Pdf417
@@ -10,11 +10,12 @@
 #include "DecoderResult.h"
 #include "PDFDecoderResultExtra.h"
 #include "ZXAlgorithms.h"
-#include "ZXBigInteger.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <sstream>
 #include <utility>
 
@@ -449,23 +450,40 @@ Remove leading 1 =>  Result is 000213298174000
 */
 static std::string DecodeBase900toBase10(const std::vector<int>& codewords, int endIndex, int count)
 {
-	// Table containing values for the exponent of 900.
-	static const auto EXP900 = []() {
-		std::array<BigInteger, 16> table = {1, 900};
-		for (size_t i = 2; i < table.size(); ++i)
-			table[i] = table[i - 1] * 900;
-		return table;
-	}();
-
+	// 929^16 < 2^160, so the value fits into 5 32-bit limbs (least significant first)
 	assert(count <= 16);
+	std::array<uint32_t, 5> value = {};
+
+	for (int i = endIndex - count; i < endIndex; i++) {
+		if (codewords[i] < 0)
+			throw FormatError();
+		uint64_t carry = codewords[i];
+		for (auto& limb : value) {
+			carry += uint64_t(limb) * 900;
+			limb = static_cast<uint32_t>(carry);
+			carry >>= 32;
+		}
+		if (carry)
+			throw FormatError();
+	}
 
-	BigInteger result;
-	for (int i = 0; i < count; i++)
-		result += EXP900[count - i - 1] * codewords[endIndex - count + i];
+	// Convert to decimal in chunks of 9 digits, starting with the least significant one
+	std::array<char, 6 * 9> digits;
+	auto pos = digits.end();
+	while (std::any_of(value.begin(), value.end(), [](uint32_t limb) { return limb != 0; })) {
+		uint64_t rem = 0;
+		for (auto limb = value.rbegin(); limb != value.rend(); ++limb) {
+			uint64_t cur = (rem << 32) | *limb;
+			*limb = static_cast<uint32_t>(cur / 1000000000);
+			rem = cur % 1000000000;
+		}
+		bool isLast = std::all_of(value.begin(), value.end(), [](uint32_t limb) { return limb == 0; });
+		for (int i = 0; i < 9 && (rem || !isLast); ++i, rem /= 10)
+			*--pos = static_cast<char>('0' + rem % 10);
+	}
 
-	std::string resultString = result.toString();
-	if (!resultString.empty() && resultString.front() == '1')
-		return resultString.substr(1);
+	if (pos != digits.end() && *pos == '1')
+		return std::string(pos + 1, digits.end());
 
 	throw FormatError();
 }
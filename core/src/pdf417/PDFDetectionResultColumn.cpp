@@ -15,7 +15,6 @@
 namespace ZXing {
 namespace Pdf417 {
 
-static const int MAX_NEARBY_DISTANCE = 5;
 static const int MIN_ROWS_IN_BARCODE = 3;
 static const int MAX_ROWS_IN_BARCODE = 90;
 
@@ -304,14 +303,14 @@ DetectionResultColumn::getBarcodeMetadata(BarcodeMetadata& result)
 		}
 	}
 	// Maybe we should check if we have ambiguous values?
-	auto cc = barcodeColumnCount.value();
-	auto rcu = barcodeRowCountUpperPart.value();
-	auto rcl = barcodeRowCountLowerPart.value();
-	auto ec = barcodeECLevel.value();
-	if (cc.empty() || rcu.empty() || rcl.empty() || ec.empty() || cc[0] < 1 || rcu[0] + rcl[0] < MIN_ROWS_IN_BARCODE || rcu[0] + rcl[0] > MAX_ROWS_IN_BARCODE) {
+	int cc = barcodeColumnCount.value();
+	int rcu = barcodeRowCountUpperPart.value();
+	int rcl = barcodeRowCountLowerPart.value();
+	int ec = barcodeECLevel.value();
+	if (cc == -1 || rcu == -1 || rcl == -1 || ec == -1 || cc < 1 || rcu + rcl < MIN_ROWS_IN_BARCODE || rcu + rcl > MAX_ROWS_IN_BARCODE) {
 		return false;
 	}
-	result = { cc[0], rcu[0], rcl[0], ec[0] };
+	result = { cc, rcu, rcl, ec };
 	RemoveIncorrectCodewords(isLeftRowIndicator(), codewords, result);
 	return true;
 }
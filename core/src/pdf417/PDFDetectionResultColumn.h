@@ -29,6 +29,9 @@ public:
 		Right,
 	};
 
+	// codewordNearby() looks up to MAX_NEARBY_DISTANCE - 1 rows above and below the given one
+	static constexpr int MAX_NEARBY_DISTANCE = 5;
+
 	DetectionResultColumn() {}
 	explicit DetectionResultColumn(const BoundingBox& boundingBox, RowIndicator rowInd = RowIndicator::None);
 
@@ -15,7 +15,6 @@
 #include <cstdlib>
 #include <limits>
 #include <list>
-#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -46,8 +45,9 @@ static const int BARCODE_MIN_HEIGHT = 10;
 * @param maxIndividualVariance The most any counter can differ before we give up
 * @return ratio of total variance between counters and pattern compared to total pattern size
 */
+template <size_t N>
 static float
-PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& pattern, float maxIndividualVariance)
+PatternMatchVariance(const std::array<int, N>& counters, const std::array<int, N>& pattern, float maxIndividualVariance)
 {
 	int total = 0;
 	int patternLength = 0;
@@ -90,11 +90,12 @@ PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& p
 * @param counters array of counters, as long as pattern, to re-use
 * @return start/end horizontal offset of guard pattern, as an array of two ints.
 */
+template <size_t N>
 static bool
-FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool whiteFirst, const std::vector<int>& pattern, std::vector<int>& counters, int& startPos, int& endPos)
+FindGuardPattern(const RotatedBitMatrix& matrix, int column, int row, int width, bool whiteFirst, const std::array<int, N>& pattern, std::array<int, N>& counters, int& startPos, int& endPos)
 {
-	std::fill(counters.begin(), counters.end(), 0);
-	int patternLength = Size(pattern);
+	counters.fill(0);
+	constexpr int patternLength = N;
 	bool isWhite = whiteFirst;
 	int patternStart = column;
 	int pixelDrift = 0;
@@ -140,13 +141,14 @@ FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool w
 	return false;
 }
 
+template <size_t N>
 static std::array<Nullable<ResultPoint>, 4>&
-FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow, int startColumn, const std::vector<int>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
+FindRowsWithPattern(const RotatedBitMatrix& matrix, int height, int width, int startRow, int startColumn, const std::array<int, N>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
 {
 	bool found = false;
 	int startPos, endPos;
 	int minStartRow = startRow;
-	std::vector<int> counters(pattern.size(), 0);
+	std::array<int, N> counters;
 	for (; startRow < height; startRow += ROW_STEP) {
 		if (FindGuardPattern(matrix, startColumn, startRow, width, false, pattern, counters, startPos, endPos)) {
 			while (startRow > minStartRow + 1) {
@@ -219,13 +221,13 @@ CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Null
 *           vertices[6] x, y top right codeword area
 *           vertices[7] x, y bottom right codeword area
 */
-static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix, int startRow, int startColumn)
+static std::array<Nullable<ResultPoint>, 8> FindVertices(const RotatedBitMatrix& matrix, int startRow, int startColumn)
 {
 	// B S B S B S B S Bar/Space pattern
 	// 11111111 0 1 0 1 0 1 000
-	static const std::vector<int> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
+	static constexpr std::array<int, 8> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
 	// 1111111 0 1 000 1 0 1 00 1
-	static const std::vector<int> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
+	static constexpr std::array<int, 9> STOP_PATTERN = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
 
 	int width = matrix.width();
 	int height = matrix.height();
@@ -254,7 +256,7 @@ static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix
 * @param bitMatrix bit matrix to detect barcodes in
 * @return List of ResultPoint arrays containing the coordinates of found barcodes
 */
-static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMatrix& bitMatrix, bool multiple)
+static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const RotatedBitMatrix& bitMatrix, bool multiple)
 {
 	int row = 0;
 	int column = 0;
@@ -303,7 +305,7 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 	return barcodeCoordinates;
 }
 
-bool HasStartPattern(const BitMatrix& m, bool rotate90)
+static bool HasStartPattern(const BitMatrix& m, bool rotate90)
 {
 	constexpr FixedPattern<8, 17> START_PATTERN = { 8, 1, 1, 1, 1, 1, 1, 3 };
 	constexpr int minSymbolWidth = 3*8+1; // compact symbol
@@ -325,7 +327,8 @@ bool HasStartPattern(const BitMatrix& m, bool rotate90)
 }
 
 /**
-* <p>Detects a PDF417 Code in an image. Only checks 0 and 180 degree rotations.</p>
+* <p>Detects a PDF417 Code in an image. Checks 0 and 180 degree rotations and, if tryRotate is set, 90 and 270 degree.
+* The rotated images are only views of the original one, see RotatedBitMatrix.</p>
 *
 * @param image barcode image to decode
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
@@ -333,9 +336,8 @@ bool HasStartPattern(const BitMatrix& m, bool rotate90)
 */
 Detector::Result Detector::Detect(const BinaryBitmap& image, bool multiple, bool tryRotate)
 {
-	// construct a 'dummy' shared pointer, just be able to pass it up the call chain in DetectorResult
 	// TODO: reimplement PDF Detector
-	auto binImg = std::shared_ptr<const BitMatrix>(image.getBitMatrix(), [](const BitMatrix*){});
+	auto binImg = image.getBitMatrix();
 	if (!binImg)
 		return {};
 
@@ -345,25 +347,12 @@ Detector::Result Detector::Detect(const BinaryBitmap& image, bool multiple, bool
 		if (!HasStartPattern(*binImg, rotate90))
 			continue;
 
-		result.rotation = 90 * rotate90;
-		if (rotate90) {
-			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
-			newBits->rotate90();
-			binImg = newBits;
+		for (int rotation : {90 * rotate90, 90 * rotate90 + 180}) {
+			result.image = RotatedBitMatrix(*binImg, rotation);
+			result.points = DetectBarcode(result.image, multiple);
+			if (!result.points.empty())
+				return result;
 		}
-
-		result.points = DetectBarcode(*binImg, multiple);
-		result.bits = binImg;
-		if (result.points.empty()) {
-			auto newBits = std::make_shared<BitMatrix>(binImg->copy());
-			newBits->rotate180();
-			result.points = DetectBarcode(*newBits, multiple);
-			result.rotation += 180;
-			result.bits = newBits;
-		}
-
-		if (!result.points.empty())
-			return result;
 	}
 
 	return {};
@@ -6,16 +6,15 @@
 
 #pragma once
 
+#include "PDFRotatedBitMatrix.h"
 #include "ResultPoint.h"
 #include "ZXNullable.h"
 
 #include <list>
 #include <array>
-#include <memory>
 
 namespace ZXing {
 
-class BitMatrix;
 class BinaryBitmap;
 
 namespace Pdf417 {
@@ -33,9 +32,8 @@ class Detector
 public:
 	struct Result
 	{
-		std::shared_ptr<const BitMatrix> bits;
+		RotatedBitMatrix image; // view of the binarized input image in which the points were found
 		std::list<std::array<Nullable<ResultPoint>, 8>> points;
-		int rotation = -1;
 	};
 
 	static Result Detect(const BinaryBitmap& image, bool multiple, bool tryRotate);
@@ -95,6 +95,15 @@ public:
 		_matrix[y].set(x, value);
 	}
 
+	int rows() const {
+		return Size(_matrix);
+	}
+
+	// the number of data columns, i.e. without start/stop patterns and row indicators
+	int columns() const {
+		return _width / 17;
+	}
+
 	void startRow() {
 		++_currentRow;
 	}
@@ -126,6 +135,11 @@ public:
 class Encoder
 {
 public:
+	/**
+	* default error correction level
+	*/
+	static constexpr int DEFAULT_ERROR_CORRECTION_LEVEL = 2;
+
 	explicit Encoder(bool compact = false) : _compact(compact)  {}
 	
 	BarcodeMatrix generateBarcodeLogic(const std::wstring& msg, int errorCorrectionLevel) const;
@@ -64,28 +64,19 @@ static int GetMaxCodewordWidth(const std::array<Nullable<ResultPoint>, 8>& p)
 					std::max(GetMaxWidth(p[1], p[5]), GetMaxWidth(p[7], p[3]) * CodewordDecoder::MODULES_IN_CODEWORD / MODULES_IN_STOP_PATTERN));
 }
 
-static Barcodes DoDecode(const BinaryBitmap& image, bool multiple, bool tryRotate, bool returnErrors)
+static Barcodes DoDecode(const BinaryBitmap& image, bool multiple, bool tryRotate, bool returnErrors, int maxThreadCount)
 {
 	Detector::Result detectorResult = Detector::Detect(image, multiple, tryRotate);
 	if (detectorResult.points.empty())
 		return {};
 
-	auto rotate = [res = detectorResult](PointI p) {
-		switch(res.rotation) {
-		case 90: return PointI(res.bits->height() - p.y - 1, p.x);
-		case 180: return PointI(res.bits->width() - p.x - 1, res.bits->height() - p.y - 1);
-		case 270: return PointI(p.y, res.bits->width() - p.x - 1);
-		}
-		return p;
-	};
-
 	Barcodes res;
 	for (const auto& points : detectorResult.points) {
 		DecoderResult decoderResult =
-			ScanningDecoder::Decode(*detectorResult.bits, points[4], points[5], points[6], points[7],
-									GetMinCodewordWidth(points), GetMaxCodewordWidth(points));
+			ScanningDecoder::Decode(detectorResult.image, points[4], points[5], points[6], points[7],
+									GetMinCodewordWidth(points), GetMaxCodewordWidth(points), maxThreadCount);
 		if (decoderResult.isValid(returnErrors)) {
-			auto point = [&](int i) { return rotate(PointI(points[i].value())); };
+			auto point = [&](int i) { return detectorResult.image.toOriginal(PointI(points[i].value())); };
 			res.emplace_back(std::move(decoderResult), DetectorResult{{}, {point(0), point(2), point(3), point(1)}},
 							 BarcodeFormat::PDF417);
 			if (!multiple)
@@ -307,12 +298,12 @@ Reader::decode(const BinaryBitmap& image) const
 		// currently the best option to deal with 'aliased' input like e.g. 03-aliased.png
 	}
 	
-	return FirstOrDefault(DoDecode(image, false, _opts.tryRotate(), _opts.returnErrors()));
+	return FirstOrDefault(DoDecode(image, false, _opts.tryRotate(), _opts.returnErrors(), _opts.maxThreadCount()));
 }
 
 Barcodes Reader::decode(const BinaryBitmap& image, [[maybe_unused]] int maxSymbols) const
 {
-	return DoDecode(image, true, _opts.tryRotate(), _opts.returnErrors());
+	return DoDecode(image, true, _opts.tryRotate(), _opts.returnErrors(), _opts.maxThreadCount());
 }
 
 } // Pdf417
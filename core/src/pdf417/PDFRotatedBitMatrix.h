@@ -0,0 +1,62 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "BitMatrix.h"
+
+#include <cstdint>
+
+namespace ZXing {
+namespace Pdf417 {
+
+/**
+* Read-only view of a BitMatrix rotated clockwise by 0, 90, 180 or 270 degrees. It gives the same pixels as a rotated
+* copy (see BitMatrix::rotate90() and rotate180()) but walks the original data with a pair of strides instead.
+* The referenced BitMatrix has to outlive the view.
+*/
+class RotatedBitMatrix
+{
+	const uint8_t* _origin = nullptr; // pixel (0, 0) of the rotated image
+	int _dx = 0, _dy = 0;            // offset between horizontally / vertically neighboring pixels of the rotated image
+	int _width = 0, _height = 0;
+	int _rotation = 0;
+
+public:
+	RotatedBitMatrix() = default;
+	RotatedBitMatrix(const BitMatrix& bits, int rotation) : _rotation(rotation)
+	{
+		const uint8_t* data = bits.row(0).begin();
+		const int w = bits.width(), h = bits.height();
+		switch (rotation) {
+		case 0: _origin = data, _dx = 1, _dy = w, _width = w, _height = h; break;
+		case 90: _origin = data + w - 1, _dx = w, _dy = -1, _width = h, _height = w; break;
+		case 180: _origin = data + w * h - 1, _dx = -1, _dy = -w, _width = w, _height = h; break;
+		case 270: _origin = data + (h - 1) * w, _dx = -w, _dy = 1, _width = h, _height = w; break;
+		}
+	}
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	int rotation() const { return _rotation; }
+
+	bool get(int x, int y) const { return _origin[x * _dx + y * _dy]; }
+
+	/**
+	* @return the position in the original BitMatrix of the pixel p of the rotated image
+	*/
+	PointI toOriginal(PointI p) const
+	{
+		switch (_rotation) {
+		case 90: return {_height - p.y - 1, p.x};
+		case 180: return {_width - p.x - 1, _height - p.y - 1};
+		case 270: return {p.y, _width - p.x - 1};
+		}
+		return p;
+	}
+};
+
+} // Pdf417
+} // ZXing
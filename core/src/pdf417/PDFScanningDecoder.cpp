@@ -6,18 +6,25 @@
 
 #include "PDFScanningDecoder.h"
 
-#include "BitMatrix.h"
 #include "DecoderResult.h"
+#include "Matrix.h"
 #include "PDFBarcodeMetadata.h"
 #include "PDFBarcodeValue.h"
 #include "PDFCodewordDecoder.h"
 #include "PDFDetectionResult.h"
 #include "PDFDecoder.h"
 #include "PDFModulusGF.h"
+#include "PDFRotatedBitMatrix.h"
+#include "Scope.h"
 #include "ZXAlgorithms.h"
 #include "ZXTestSupport.h"
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -28,7 +35,7 @@ static const int MAX_EC_CODEWORDS = 512;
 
 using ModuleBitCountType = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
 
-static int AdjustCodewordStartColumn(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int codewordStartColumn, int imageRow)
+static int AdjustCodewordStartColumn(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int codewordStartColumn, int imageRow)
 {
 	int correctedStartColumn = codewordStartColumn;
 	int increment = leftToRight ? -1 : 1;
@@ -47,7 +54,7 @@ static int AdjustCodewordStartColumn(const BitMatrix& image, int minColumn, int
 	return correctedStartColumn;
 }
 
-static bool GetModuleBitCount(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, ModuleBitCountType& moduleBitCount)
+static bool GetModuleBitCount(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, ModuleBitCountType& moduleBitCount)
 {
 	int imageColumn = startColumn;
 	size_t moduleNumber = 0;
@@ -104,7 +111,7 @@ static int GetCodewordBucketNumber(int codeword)
 	return GetCodewordBucketNumber(GetBitCountForCodeword(codeword));
 }
 
-static Nullable<Codeword> DetectCodeword(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, int minCodewordWidth, int maxCodewordWidth)
+static Nullable<Codeword> DetectCodeword(const RotatedBitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int startColumn, int imageRow, int minCodewordWidth, int maxCodewordWidth)
 {
 	startColumn = AdjustCodewordStartColumn(image, minColumn, maxColumn, leftToRight, startColumn, imageRow);
 	// we usually know fairly exact now how long a codeword is. We should provide minimum and maximum expected length
@@ -155,7 +162,7 @@ static Nullable<Codeword> DetectCodeword(const BitMatrix& image, int minColumn,
 	return nullptr;
 }
 
-static DetectionResultColumn GetRowIndicatorColumn(const BitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
+static DetectionResultColumn GetRowIndicatorColumn(const RotatedBitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
 {
 	DetectionResultColumn rowIndicatorColumn(boundingBox, leftToRight ? DetectionResultColumn::RowIndicator::Left : DetectionResultColumn::RowIndicator::Right);
 	for (int i = 0; i < 2; i++) {
@@ -267,7 +274,8 @@ static bool IsValidBarcodeColumn(const DetectionResult& detectionResult, int bar
 	return barcodeColumn >= 0 && barcodeColumn <= detectionResult.barcodeColumnCount() + 1;
 }
 
-static int GetStartColumn(const DetectionResult& detectionResult, int barcodeColumn, int imageRow, bool leftToRight)
+static int GetStartColumn(const DetectionResult& detectionResult, const DetectionResultColumn& current, int barcodeColumn,
+						  int imageRow, bool leftToRight)
 {
 	int offset = leftToRight ? 1 : -1;
 	Nullable<Codeword> codeword;
@@ -277,7 +285,7 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	if (codeword != nullptr) {
 		return leftToRight ? codeword.value().endX() : codeword.value().startX();
 	}
-	codeword = detectionResult.column(barcodeColumn).value().codewordNearby(imageRow);
+	codeword = current.codewordNearby(imageRow);
 	if (codeword != nullptr) {
 		return leftToRight ? codeword.value().startX() : codeword.value().endX();
 	}
@@ -304,12 +312,9 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	return leftToRight ? detectionResult.getBoundingBox().value().minX() : detectionResult.getBoundingBox().value().maxX();
 }
 
-static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResult& detectionResult)
+static Matrix<BarcodeValue> CreateBarcodeMatrix(DetectionResult& detectionResult)
 {
-	std::vector<std::vector<BarcodeValue>> barcodeMatrix(detectionResult.barcodeRowCount());
-	for (auto& row : barcodeMatrix) {
-		row.resize(detectionResult.barcodeColumnCount() + 2);
-	}
+	Matrix<BarcodeValue> barcodeMatrix(detectionResult.barcodeColumnCount() + 2, detectionResult.barcodeRowCount());
 
 	int column = 0;
 	for (auto& resultColumn : detectionResult.allColumns()) {
@@ -318,11 +323,11 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 				if (codeword != nullptr) {
 					int rowNumber = codeword.value().rowNumber();
 					if (rowNumber >= 0) {
-						if (rowNumber >= Size(barcodeMatrix)) {
+						if (rowNumber >= barcodeMatrix.height()) {
 							// We have more rows than the barcode metadata allows for, ignore them.
 							continue;
 						}
-						barcodeMatrix[rowNumber][column].setValue(codeword.value().value());
+						barcodeMatrix(column, rowNumber).setValue(codeword.value().value());
 					}
 				}
 			}
@@ -337,20 +342,20 @@ static int GetNumberOfECCodeWords(int barcodeECLevel)
 	return 2 << barcodeECLevel;
 }
 
-static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
+static bool AdjustCodewordCount(const DetectionResult& detectionResult, Matrix<BarcodeValue>& barcodeMatrix)
 {
-	auto numberOfCodewords = barcodeMatrix[0][1].value();
+	int numberOfCodewords = barcodeMatrix(1, 0).value();
 	int calculatedNumberOfCodewords = detectionResult.barcodeColumnCount() * detectionResult.barcodeRowCount() - GetNumberOfECCodeWords(detectionResult.barcodeECLevel());
 	if (calculatedNumberOfCodewords < 1 || calculatedNumberOfCodewords > CodewordDecoder::MAX_CODEWORDS_IN_BARCODE)
 		calculatedNumberOfCodewords = 0;
-	if (numberOfCodewords.empty()) {
+	if (numberOfCodewords == -1) {
 		if (!calculatedNumberOfCodewords)
 			return false;
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix(1, 0).setValue(calculatedNumberOfCodewords);
 	}
-	else if (calculatedNumberOfCodewords && numberOfCodewords[0] != calculatedNumberOfCodewords) {
+	else if (calculatedNumberOfCodewords && numberOfCodewords != calculatedNumberOfCodewords) {
 		// The calculated one is more reliable as it is derived from the row indicator columns
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		barcodeMatrix(1, 0).setValue(calculatedNumberOfCodewords);
 	}
 	return true;
 }
@@ -653,17 +658,17 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 	std::vector<int> ambiguousIndexesList;
 	for (int row = 0; row < detectionResult.barcodeRowCount(); row++) {
 		for (int column = 0; column < detectionResult.barcodeColumnCount(); column++) {
-			auto values = barcodeMatrix[row][column + 1].value();
+			auto& barcodeValue = barcodeMatrix(column + 1, row);
 			int codewordIndex = row * detectionResult.barcodeColumnCount() + column;
-			if (values.empty()) {
+			if (int value = barcodeValue.value(); value == -1) {
 				erasures.push_back(codewordIndex);
 			}
-			else if (values.size() == 1) {
-				codewords[codewordIndex] = values[0];
+			else if (!barcodeValue.isAmbiguous()) {
+				codewords[codewordIndex] = value;
 			}
 			else {
 				ambiguousIndexesList.push_back(codewordIndex);
-				ambiguousIndexValues.push_back(values);
+				ambiguousIndexValues.push_back(barcodeValue.values());
 			}
 		}
 	}
@@ -672,14 +677,221 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 }
 
 
+// the state carried from one image row to the next while scanning a barcode column
+struct RowScanState
+{
+	int previousStartColumn = -1;
+	int minCodewordWidth = 0;
+	int maxCodewordWidth = 0;
+
+	bool operator==(const RowScanState& o) const
+	{
+		return previousStartColumn == o.previousStartColumn && minCodewordWidth == o.minCodewordWidth
+			   && maxCodewordWidth == o.maxCodewordWidth;
+	}
+};
+
+/**
+* Detect the codeword of barcodeColumn in imageRow and store it in current, the column being scanned. The codewords of
+* a column are located relative to the ones of the neighboring column and of nearby rows, so the columns have to be
+* processed in order.
+*/
+static void DetectRowCodeword(const RotatedBitMatrix& image, const BoundingBox& boundingBox, const DetectionResult& detectionResult,
+							  DetectionResultColumn& current, int barcodeColumn, int imageRow, bool leftToRight, RowScanState& state)
+{
+	int startColumn = GetStartColumn(detectionResult, current, barcodeColumn, imageRow, leftToRight);
+	if (startColumn < 0 || startColumn > boundingBox.maxX()) {
+		if (state.previousStartColumn == -1) {
+			return;
+		}
+		startColumn = state.previousStartColumn;
+	}
+	Nullable<Codeword> codeword = DetectCodeword(image, boundingBox.minX(), boundingBox.maxX(), leftToRight, startColumn, imageRow,
+												 state.minCodewordWidth, state.maxCodewordWidth);
+	if (codeword != nullptr) {
+		current.setCodeword(imageRow, codeword);
+		state.previousStartColumn = startColumn;
+		UpdateMinMax(state.minCodewordWidth, state.maxCodewordWidth, codeword.value().width());
+	}
+}
+
+static bool IsSameCodeword(const Nullable<Codeword>& a, const Nullable<Codeword>& b)
+{
+	if (a == nullptr || b == nullptr)
+		return a == nullptr && b == nullptr;
+	return a.value().startX() == b.value().startX() && a.value().endX() == b.value().endX()
+		   && a.value().bucket() == b.value().bucket() && a.value().value() == b.value().value();
+}
+
+// set up the DetectionResultColumn of the n-th column to scan, returns its index or -1 if it is a known row indicator
+static int NextBarcodeColumn(DetectionResult& detectionResult, const BoundingBox& boundingBox, int n, bool leftToRight)
+{
+	int maxBarcodeColumn = detectionResult.barcodeColumnCount() + 1;
+	int barcodeColumn = leftToRight ? n : maxBarcodeColumn - n;
+	if (detectionResult.column(barcodeColumn) != nullptr) {
+		// This will be the case for the opposite row indicator column, which doesn't need to be decoded again.
+		return -1;
+	}
+	DetectionResultColumn::RowIndicator rowIndicator = barcodeColumn == 0 ? DetectionResultColumn::RowIndicator::Left : (barcodeColumn == maxBarcodeColumn ? DetectionResultColumn::RowIndicator::Right : DetectionResultColumn::RowIndicator::None);
+	detectionResult.setColumn(barcodeColumn, DetectionResultColumn(boundingBox, rowIndicator));
+	return barcodeColumn;
+}
+
+/**
+* Detect the codewords of all data columns in all rows of the bounding box.
+*/
+static void DetectCodewords(const RotatedBitMatrix& image, const BoundingBox& boundingBox, DetectionResult& detectionResult,
+							bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
+{
+	RowScanState state = {-1, minCodewordWidth, maxCodewordWidth};
+	for (int n = 1; n <= detectionResult.barcodeColumnCount() + 1; n++) {
+		int barcodeColumn = NextBarcodeColumn(detectionResult, boundingBox, n, leftToRight);
+		if (barcodeColumn == -1)
+			continue;
+		auto& current = detectionResult.column(barcodeColumn).value();
+		// TODO start at a row for which we know the start position, then detect upwards and downwards from there.
+		state.previousStartColumn = -1;
+		for (int imageRow = boundingBox.minY(); imageRow <= boundingBox.maxY(); imageRow++)
+			DetectRowCodeword(image, boundingBox, detectionResult, current, barcodeColumn, imageRow, leftToRight, state);
+	}
+}
+
+/**
+* Same as DetectCodewords() but with each column split into horizontal bands that are scanned by up to maxThreadCount
+* threads, one column after the other. The first band starts from the exact state of the serial scan. The others start
+* from the state at the top of the column and scan into their own copy of it. Afterwards, each of those bands is
+* re-scanned serially from its top row until the state of the serial scan (codewords of the rows codewordNearby() looks
+* at, previous start column and codeword width range) matches the one of the band at that row, from where on the
+* band's result is taken as is. This makes the result identical to DetectCodewords(), usually after a few rows.
+* The number of threads is bounded by the height of the symbol (one per MIN_BAND_HEIGHT image rows), so small
+* symbols never pay for starting a thread.
+*/
+static void DetectCodewordsParallel(const RotatedBitMatrix& image, const BoundingBox& boundingBox, DetectionResult& detectionResult,
+									bool leftToRight, int minCodewordWidth, int maxCodewordWidth, int maxThreadCount)
+{
+	// bands should be large compared to the distance codewordNearby() looks at and the rows of the symbol
+	constexpr int MIN_BAND_HEIGHT = 64;
+	constexpr int NEARBY = DetectionResultColumn::MAX_NEARBY_DISTANCE - 1;
+	int rows = boundingBox.maxY() - boundingBox.minY() + 1;
+	int bandCount = std::clamp(rows / MIN_BAND_HEIGHT, 1, maxThreadCount);
+	if (bandCount == 1)
+		return DetectCodewords(image, boundingBox, detectionResult, leftToRight, minCodewordWidth, maxCodewordWidth);
+
+	auto bandRow = [&](int band) { return boundingBox.minY() + band * rows / bandCount; };
+
+	RowScanState state = {-1, minCodewordWidth, maxCodewordWidth};
+	RowScanState columnStart; // state at the top of the column, read by the worker threads
+	int barcodeColumn = -1;
+	std::vector<DetectionResultColumn> bandColumns(bandCount);
+	// states[i][k] is the state of band i before scanning its k-th row (and after its last one for k == band height)
+	std::vector<std::vector<RowScanState>> states(bandCount);
+
+	auto scanBand = [&](int i) {
+		auto& bandStates = states[i];
+		auto bandState = columnStart;
+		bandStates.assign(1, bandState);
+		for (int imageRow = bandRow(i); imageRow < bandRow(i + 1); ++imageRow) {
+			DetectRowCodeword(image, boundingBox, detectionResult, bandColumns[i], barcodeColumn, imageRow, leftToRight, bandState);
+			bandStates.push_back(bandState);
+		}
+	};
+
+	// the worker threads scan the bands 1..bandCount-1 of the column set up by this thread for each new generation
+	std::mutex mutex;
+	std::condition_variable cv;
+	int generation = 0, pending = 0;
+	bool done = false;
+
+	std::vector<std::thread> threads;
+	threads.reserve(bandCount - 1);
+	// the threads reference local variables, stop and join them even if scanning throws
+	SCOPE_EXIT([&] {
+		{
+			std::lock_guard lock(mutex);
+			done = true;
+		}
+		cv.notify_all();
+		for (auto& thread : threads)
+			thread.join();
+	});
+	for (int i = 1; i < bandCount; ++i)
+		threads.emplace_back([&, i] {
+			for (int seen = 0;;) {
+				{
+					std::unique_lock lock(mutex);
+					cv.wait(lock, [&] { return done || generation != seen; });
+					if (done)
+						return;
+					seen = generation;
+				}
+				scanBand(i);
+				std::lock_guard lock(mutex);
+				if (--pending == 0)
+					cv.notify_all();
+			}
+		});
+
+	for (int n = 1; n <= detectionResult.barcodeColumnCount() + 1; n++) {
+		barcodeColumn = NextBarcodeColumn(detectionResult, boundingBox, n, leftToRight);
+		if (barcodeColumn == -1)
+			continue;
+		auto& current = detectionResult.column(barcodeColumn).value();
+		for (int i = 1; i < bandCount; ++i)
+			bandColumns[i] = current;
+
+		state.previousStartColumn = -1;
+		columnStart = state;
+		{
+			std::lock_guard lock(mutex);
+			++generation;
+			pending = bandCount - 1;
+		}
+		cv.notify_all();
+
+		// the first band starts like the serial scan, so it can work on the column directly
+		for (int imageRow = bandRow(0); imageRow < bandRow(1); ++imageRow)
+			DetectRowCodeword(image, boundingBox, detectionResult, current, barcodeColumn, imageRow, leftToRight, state);
+
+		{
+			std::unique_lock lock(mutex);
+			cv.wait(lock, [&] { return pending == 0; });
+		}
+
+		for (int i = 1; i < bandCount; ++i) {
+			auto& bandCodewords = bandColumns[i].allCodewords();
+			auto& codewords = current.allCodewords();
+			// from row r on, the band result is the serial one if the inputs of the serial scan of row r are the same
+			auto converged = [&](int r) {
+				if (!(state == states[i][r - bandRow(i)]))
+					return false;
+				for (int k = std::max(r - NEARBY, boundingBox.minY()); k < r; ++k) {
+					int index = current.imageRowToCodewordIndex(k);
+					if (!IsSameCodeword(codewords[index], k < bandRow(i) ? Nullable<Codeword>() : bandCodewords[index]))
+						return false;
+				}
+				return true;
+			};
+			int imageRow = bandRow(i);
+			for (; imageRow < bandRow(i + 1) && !converged(imageRow); ++imageRow)
+				DetectRowCodeword(image, boundingBox, detectionResult, current, barcodeColumn, imageRow, leftToRight, state);
+			if (imageRow < bandRow(i + 1)) {
+				for (; imageRow < bandRow(i + 1); ++imageRow)
+					if (auto& codeword = bandCodewords[current.imageRowToCodewordIndex(imageRow)]; codeword != nullptr)
+						current.setCodeword(imageRow, codeword);
+				state = states[i].back();
+			}
+		}
+	}
+}
+
 // TODO don't pass in minCodewordWidth and maxCodewordWidth, pass in barcode columns for start and stop pattern
 // columns. That way width can be deducted from the pattern column.
 // This approach also allows detecting more details about the barcode, e.g. if a bar type (white or black) is wider 
 // than it should be. This can happen if the scanner used a bad blackpoint.
 DecoderResult
-ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
+ScanningDecoder::Decode(const RotatedBitMatrix& image, const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
 	const Nullable<ResultPoint>& imageTopRight, const Nullable<ResultPoint>& imageBottomRight,
-	int minCodewordWidth, int maxCodewordWidth)
+	int minCodewordWidth, int maxCodewordWidth, int maxThreadCount)
 {
 	BoundingBox boundingBox;
 	if (!BoundingBox::Create(image.width(), image.height(), imageTopLeft, imageBottomLeft, imageTopRight, imageBottomRight, boundingBox)) {
@@ -712,33 +924,11 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 	detectionResult.setColumn(maxBarcodeColumn, rightRowIndicatorColumn);
 
 	bool leftToRight = leftRowIndicatorColumn != nullptr;
-	for (int barcodeColumnCount = 1; barcodeColumnCount <= maxBarcodeColumn; barcodeColumnCount++) {
-		int barcodeColumn = leftToRight ? barcodeColumnCount : maxBarcodeColumn - barcodeColumnCount;
-		if (detectionResult.column(barcodeColumn) != nullptr) {
-			// This will be the case for the opposite row indicator column, which doesn't need to be decoded again.
-			continue;
-		}
-		DetectionResultColumn::RowIndicator rowIndicator = barcodeColumn == 0 ? DetectionResultColumn::RowIndicator::Left : (barcodeColumn == maxBarcodeColumn ? DetectionResultColumn::RowIndicator::Right : DetectionResultColumn::RowIndicator::None);
-		detectionResult.setColumn(barcodeColumn, DetectionResultColumn(boundingBox, rowIndicator));
-		int startColumn = -1;
-		int previousStartColumn = startColumn;
-		// TODO start at a row for which we know the start position, then detect upwards and downwards from there.
-		for (int imageRow = boundingBox.minY(); imageRow <= boundingBox.maxY(); imageRow++) {
-			startColumn = GetStartColumn(detectionResult, barcodeColumn, imageRow, leftToRight);
-			if (startColumn < 0 || startColumn > boundingBox.maxX()) {
-				if (previousStartColumn == -1) {
-					continue;
-				}
-				startColumn = previousStartColumn;
-			}
-			Nullable<Codeword> codeword = DetectCodeword(image, boundingBox.minX(), boundingBox.maxX(), leftToRight, startColumn, imageRow, minCodewordWidth, maxCodewordWidth);
-			if (codeword != nullptr) {
-				detectionResult.column(barcodeColumn).value().setCodeword(imageRow, codeword);
-				previousStartColumn = startColumn;
-				UpdateMinMax(minCodewordWidth, maxCodewordWidth, codeword.value().width());
-			}
-		}
-	}
+	if (maxThreadCount > 1)
+		DetectCodewordsParallel(image, boundingBox, detectionResult, leftToRight, minCodewordWidth, maxCodewordWidth, maxThreadCount);
+	else
+		DetectCodewords(image, boundingBox, detectionResult, leftToRight, minCodewordWidth, maxCodewordWidth);
+
 	return CreateDecoderResult(detectionResult);
 }
 
@@ -10,23 +10,24 @@
 
 namespace ZXing {
 
-class BitMatrix;
 class ResultPoint;
 class DecoderResult;
 template <typename T> class Nullable;
 
 namespace Pdf417 {
 
+class RotatedBitMatrix;
+
 /**
 * @author Guenther Grau
 */
 class ScanningDecoder
 {
 public:
-	static DecoderResult Decode(const BitMatrix& image,
+	static DecoderResult Decode(const RotatedBitMatrix& image,
 		const Nullable<ResultPoint>& imageTopLeft, const Nullable<ResultPoint>& imageBottomLeft,
 		const Nullable<ResultPoint>& imageTopRight, const Nullable<ResultPoint>& imageBottomRight,
-		int minCodewordWidth, int maxCodewordWidth);
+		int minCodewordWidth, int maxCodewordWidth, int maxThreadCount = 1);
 };
 
 inline int NumECCodeWords(int ecLevel)
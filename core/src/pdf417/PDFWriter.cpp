@@ -19,11 +19,6 @@ namespace Pdf417 {
 */
 static const int WHITE_SPACE = 30;
 
-/**
-* default error correction level
-*/
-static const int DEFAULT_ERROR_CORRECTION_LEVEL = 2;
-
 /**
 * Takes and rotates the it 90 degrees
 */
@@ -72,7 +67,7 @@ BitMatrix
 Writer::encode(const std::wstring& contents, int width, int height) const
 {
 	int margin = _margin >= 0 ? _margin : WHITE_SPACE;
-	int ecLevel = _ecLevel >= 0 ? _ecLevel : DEFAULT_ERROR_CORRECTION_LEVEL;
+	int ecLevel = _ecLevel >= 0 ? _ecLevel : Encoder::DEFAULT_ERROR_CORRECTION_LEVEL;
 
 	BarcodeMatrix resultMatrix = _encoder->generateBarcodeLogic(contents, ecLevel);
 	int aspectRatio = 4; // keep in sync with MODULE_RATIO in PDFEncoder.cpp
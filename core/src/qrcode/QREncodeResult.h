@@ -8,6 +8,7 @@
 
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "ECI.h"
 #include "QRCodecMode.h"
 #include "QRVersion.h"
 
@@ -24,7 +25,8 @@ class EncodeResult
 {
 public:
 	ErrorCorrectionLevel ecLevel = ErrorCorrectionLevel::Invalid;
-	CodecMode mode = CodecMode::TERMINATOR;
+	CodecMode mode = CodecMode::TERMINATOR; // mode of the first segment
+	ECI eci = ECI::Unknown; // the ECI announced in front of the data, if any
 	const Version* version = nullptr;
 	int maskPattern = -1;
 	BitMatrix matrix;
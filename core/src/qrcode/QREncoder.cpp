@@ -11,7 +11,6 @@
 #include "GenericGF.h"
 #include "QREncodeResult.h"
 #include "QRErrorCorrectionLevel.h"
-#include "QRMaskUtil.h"
 #include "QRMatrixUtil.h"
 #include "ReedSolomonEncoder.h"
 #include "TextEncoder.h"
@@ -21,6 +20,8 @@
 #include <array>
 #include <limits>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace ZXing::QRCode {
 
@@ -247,6 +248,93 @@ void AppendBytes(const std::wstring& content, CodecMode mode, CharacterSet encod
 	}
 }
 
+static bool IsDoubleByteKanji(const std::string& sjis)
+{
+	if (sjis.size() != 2)
+		return false;
+	int code = ((sjis[0] & 0xff) << 8) | (sjis[1] & 0xff);
+	return (code >= 0x8140 && code <= 0x9ffc) || (code >= 0xe040 && code <= 0xebbf);
+}
+
+/**
+* Split the content into the sequence of mode segments that needs the least number of bits in the given version (the
+* width of the character count fields only changes between the version ranges 1-9, 10-26 and 27-40). This is a shortest
+* path search over the characters where the states are the current mode plus, for numeric and alphanumeric mode, the
+* number of characters in the last incomplete group. That way the costs of every transition are exact bit counts.
+* The Kanji mode is only considered if the encoding is Shift_JIS, like in ChooseMode.
+*
+* @return a list of (mode, number of characters) pairs
+*/
+ZXING_EXPORT_TEST_ONLY
+std::vector<std::pair<CodecMode, int>> ChooseSegments(const std::wstring& content, CharacterSet encoding, const Version& version)
+{
+	enum State { N0, N1, N2, A0, A1, B, K, NUM_STATES };
+	constexpr CodecMode MODES[NUM_STATES] = {CodecMode::NUMERIC,      CodecMode::NUMERIC, CodecMode::NUMERIC, CodecMode::ALPHANUMERIC,
+											 CodecMode::ALPHANUMERIC, CodecMode::BYTE,    CodecMode::KANJI};
+	constexpr int INF = std::numeric_limits<int>::max() / 2;
+
+	auto header = [&](CodecMode mode) { return 4 + CharacterCountBits(mode, version); };
+
+	const int length = Size(content);
+	std::vector<std::array<int, NUM_STATES>> costs(length + 1);
+	std::vector<std::array<int8_t, NUM_STATES>> from(length + 1);
+	costs[0].fill(INF);
+	costs[0][B] = 0; // arbitrary origin, the first character always starts a new segment
+
+	for (int i = 0; i < length; ++i) {
+		auto& cur = costs[i];
+		auto& next = costs[i + 1];
+		next.fill(INF);
+
+		int cheapest = int(std::min_element(cur.begin(), cur.end()) - cur.begin());
+		auto relax = [&](State to, int fromState, int bits) {
+			if (cur[fromState] + bits < next[to]) {
+				next[to] = cur[fromState] + bits;
+				from[i + 1][to] = fromState;
+			}
+		};
+		// continue the current segment in state 's' or start a new one of mode 'to' after the cheapest state
+		auto extend = [&](State to, State s, int bits) {
+			if (i > 0)
+				relax(to, s, bits);
+		};
+		auto start = [&](State to, int bits) { relax(to, cheapest, header(MODES[to]) + bits); };
+
+		wchar_t c = content[i];
+		if (c >= '0' && c <= '9') {
+			extend(N1, N0, 4);
+			extend(N2, N1, 3);
+			extend(N0, N2, 3);
+			start(N1, 4);
+		}
+		if (GetAlphanumericCode(c) != -1) {
+			extend(A1, A0, 6);
+			extend(A0, A1, 5);
+			start(A1, 6);
+		}
+		std::string bytes = TextEncoder::FromUnicode(std::wstring(1, c), encoding);
+		extend(B, B, 8 * Size(bytes));
+		start(B, 8 * Size(bytes));
+		if (encoding == CharacterSet::Shift_JIS && IsDoubleByteKanji(bytes)) {
+			extend(K, K, 13);
+			start(K, 13);
+		}
+	}
+
+	std::vector<std::pair<CodecMode, int>> res;
+	int state = int(std::min_element(costs[length].begin(), costs[length].end()) - costs[length].begin());
+	for (int i = length; i > 0; --i) {
+		// consecutive characters in the same mode always belong to the same segment, see 'extend' vs. 'start' above
+		if (res.empty() || res.back().first != MODES[state])
+			res.emplace_back(MODES[state], 0);
+		res.back().second++;
+		state = from[i][state];
+	}
+	std::reverse(res.begin(), res.end());
+
+	return res;
+}
+
 /**
 * @return true if the number of input bits will fit in a code with the specified version and
 * error correction level.
@@ -442,103 +530,147 @@ BitArray InterleaveWithECBytes(const BitArray& bits, int numTotalBytes, int numD
 }
 
 
-static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version, TritMatrix& matrix)
+struct Segment
 {
-	int minPenalty = std::numeric_limits<int>::max();  // Lower penalty is better.
-	int bestMaskPattern = -1;
-	// We try all mask patterns to choose the best one.
-	for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
-		BuildMatrix(bits, ecLevel, version, maskPattern, matrix);
-		int penalty = MaskUtil::CalculateMaskPenalty(matrix);
-		if (penalty < minPenalty) {
-			minPenalty = penalty;
-			bestMaskPattern = maskPattern;
-		}
+	CodecMode mode;
+	int numLetters; // characters, except for BYTE mode where it is the number of bytes
+	BitArray dataBits;
+};
+
+using Segments = std::vector<Segment>;
+
+static Segment MakeSegment(const std::wstring& content, CodecMode mode, CharacterSet charset)
+{
+	Segment segment{mode, 0, {}};
+	AppendBytes(content, mode, charset, segment.dataBits);
+	segment.numLetters = mode == CodecMode::BYTE ? segment.dataBits.sizeInBytes() : Size(content);
+	return segment;
+}
+
+static Segments MakeSegments(const std::wstring& content, CharacterSet charset, const Version& version)
+{
+	Segments res;
+	int pos = 0;
+	for (auto [mode, length] : ChooseSegments(content, charset, version)) {
+		res.push_back(MakeSegment(content.substr(pos, length), mode, charset));
+		pos += length;
+	}
+	return res;
+}
+
+// the ECI segment is only needed in front of byte mode data
+static bool HasECISegment(const Segments& segments, bool appendECI)
+{
+	return appendECI && std::any_of(segments.begin(), segments.end(), [](auto& s) { return s.mode == CodecMode::BYTE; });
+}
+
+static BitArray MakeHeaderBits(const Segments& segments, CharacterSet charset, bool appendECI, bool useGs1Format)
+{
+	BitArray bits;
+
+	// Append ECI segment if applicable
+	if (HasECISegment(segments, appendECI)) {
+		AppendECI(charset, bits);
+	}
+
+	// Append the FNC1 mode header for GS1 formatted data if applicable
+	if (useGs1Format) {
+		// GS1 formatted codes are prefixed with a FNC1 in first position mode header
+		AppendModeInfo(CodecMode::FNC1_FIRST_POSITION, bits);
 	}
-	return bestMaskPattern;
+
+	return bits;
 }
 
-static int CalculateBitsNeeded(CodecMode mode, const BitArray& headerBits, const BitArray& dataBits, const Version& version)
+static int CalculateBitsNeeded(const BitArray& headerBits, const Segments& segments, const Version& version)
 {
-	return headerBits.size() + CharacterCountBits(mode, version) + dataBits.size();
+	int bitsNeeded = headerBits.size();
+	for (auto& segment : segments)
+		bitsNeeded += 4 + CharacterCountBits(segment.mode, version) + segment.dataBits.size();
+	return bitsNeeded;
 }
 
 /**
 * Decides the smallest version of QR code that will contain all of the provided data.
 * @throws WriterException if the data cannot fit in any version
 */
-static const Version& RecommendVersion(ErrorCorrectionLevel ecLevel, CodecMode mode, const BitArray& headerBits, const BitArray& dataBits)
+static const Version& RecommendVersion(ErrorCorrectionLevel ecLevel, const BitArray& headerBits, const Segments& segments)
 {
 	// Hard part: need to know version to know how many bits length takes. But need to know how many
 	// bits it takes to know version. First we take a guess at version by assuming version will be
 	// the minimum, 1:
-	int provisionalBitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, *Version::Model2(1));
+	int provisionalBitsNeeded = CalculateBitsNeeded(headerBits, segments, *Version::Model2(1));
 	const Version& provisionalVersion = ChooseVersion(provisionalBitsNeeded, ecLevel);
 
 	// Use that guess to calculate the right version. I am still not sure this works in 100% of cases.
-	int bitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, provisionalVersion);
+	int bitsNeeded = CalculateBitsNeeded(headerBits, segments, provisionalVersion);
 	return ChooseVersion(bitsNeeded, ecLevel);
 }
 
+/**
+* Decides the smallest version and the optimal segmentation for it. The segmentation only depends on the version range
+* (see ChooseSegments), so each range is tried in turn.
+*/
+static const Version& RecommendVersion(ErrorCorrectionLevel ecLevel, const std::wstring& content, CharacterSet charset,
+									   bool appendECI, bool useGs1Format, Segments& segments, BitArray& headerBits)
+{
+	for (auto [first, last] : {std::pair{1, 9}, {10, 26}, {27, 40}}) {
+		segments = MakeSegments(content, charset, *Version::Model2(first));
+		headerBits = MakeHeaderBits(segments, charset, appendECI, useGs1Format);
+		int bitsNeeded = CalculateBitsNeeded(headerBits, segments, *Version::Model2(first));
+		for (int versionNum = first; versionNum <= last; ++versionNum)
+			if (WillFit(bitsNeeded, *Version::Model2(versionNum), ecLevel))
+				return *Version::Model2(versionNum);
+	}
+	throw std::invalid_argument("Data too big");
+}
+
 EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet charset, int versionNumber,
-					bool useGs1Format, int maskPattern)
+					bool useGs1Format, int maskPattern, bool optimizeSegments)
 {
+	if (content.empty())
+		throw std::invalid_argument("Found empty contents");
+
 	bool charsetWasUnknown = charset == CharacterSet::Unknown;
 	if (charsetWasUnknown) {
 		charset = DEFAULT_BYTE_MODE_ENCODING;
 	}
 
-	// Pick an encoding mode appropriate for the content. Note that this will not attempt to use
-	// multiple modes / segments even if that were more efficient. Twould be nice.
-	CodecMode mode = ChooseMode(content, charset);
+	// Either pick a single encoding mode appropriate for the content or split it into the sequence of
+	// segments that needs the least number of bits (see ChooseSegments).
+	const Version* version = versionNumber > 0 ? Version::Model2(versionNumber) : nullptr;
+	Segments segments;
+	if (!optimizeSegments)
+		segments.push_back(MakeSegment(content, ChooseMode(content, charset), charset));
+	else if (version)
+		segments = MakeSegments(content, charset, *version);
 
-	// This will store the header information, like mode and
-	// length, as well as "header" segments like an ECI segment.
+	// This will store the "header" segments like an ECI segment or the FNC1 mode indicator.
 	BitArray headerBits;
 
-	// Append ECI segment if applicable
-	if (mode == CodecMode::BYTE && !charsetWasUnknown) {
-		AppendECI(charset, headerBits);
-	}
-
-	// Append the FNC1 mode header for GS1 formatted data if applicable
-	if (useGs1Format) {
-		// GS1 formatted codes are prefixed with a FNC1 in first position mode header
-		AppendModeInfo(CodecMode::FNC1_FIRST_POSITION, headerBits);
-	}
-
-	// (With ECI in place,) Write the mode marker
-	AppendModeInfo(mode, headerBits);
-
-	// Collect data within the main segment, separately, to count its size if needed. Don't add it to
-	// main payload yet.
-	BitArray dataBits;
-	AppendBytes(content, mode, charset, dataBits);
-
-	const Version* version;
-	if (versionNumber > 0) {
-		version = Version::Model2(versionNumber);
-		if (version != nullptr) {
-			int bitsNeeded = CalculateBitsNeeded(mode, headerBits, dataBits, *version);
-			if (!WillFit(bitsNeeded, *version, ecLevel)) {
-				throw std::invalid_argument("Data too big for requested version");
-			}
-		}
-		else {
-			version = &RecommendVersion(ecLevel, mode, headerBits, dataBits);
+	if (version) {
+		headerBits = MakeHeaderBits(segments, charset, !charsetWasUnknown, useGs1Format);
+		int bitsNeeded = CalculateBitsNeeded(headerBits, segments, *version);
+		if (!WillFit(bitsNeeded, *version, ecLevel)) {
+			throw std::invalid_argument("Data too big for requested version");
 		}
 	}
+	else if (optimizeSegments) {
+		version = &RecommendVersion(ecLevel, content, charset, !charsetWasUnknown, useGs1Format, segments, headerBits);
+	}
 	else {
-		version = &RecommendVersion(ecLevel, mode, headerBits, dataBits);
+		headerBits = MakeHeaderBits(segments, charset, !charsetWasUnknown, useGs1Format);
+		version = &RecommendVersion(ecLevel, headerBits, segments);
 	}
 
+	// (With ECI in place,) Write the mode marker, the "length" and the data of each segment
 	BitArray headerAndDataBits;
 	headerAndDataBits.appendBitArray(headerBits);
-	// Find "length" of main segment and write it
-	int numLetters = mode == CodecMode::BYTE ? dataBits.sizeInBytes() : Size(content);
-	AppendLengthInfo(numLetters, *version, mode, headerAndDataBits);
-	// Put data together into the overall payload
-	headerAndDataBits.appendBitArray(dataBits);
+	for (auto& segment : segments) {
+		AppendModeInfo(segment.mode, headerAndDataBits);
+		AppendLengthInfo(segment.numLetters, *version, segment.mode, headerAndDataBits);
+		headerAndDataBits.appendBitArray(segment.dataBits);
+	}
 
 	auto& ecBlocks = version->ecBlocksForLevel(ecLevel);
 	int numDataBytes = version->totalCodewords() - ecBlocks.totalCodewords();
@@ -552,13 +684,14 @@ EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, C
 
 	EncodeResult output;
 	output.ecLevel = ecLevel;
-	output.mode = mode;
+	output.mode = segments.front().mode;
+	output.eci = HasECISegment(segments, !charsetWasUnknown) ? ToECI(charset) : ECI::Unknown;
 	output.version = version;
 
 	//  Choose the mask pattern and set to "qrCode".
 	int dimension = version->dimension();
 	TritMatrix matrix(dimension, dimension);
-	output.maskPattern = maskPattern != -1 ? maskPattern : ChooseMaskPattern(finalBits, ecLevel, *version, matrix);
+	output.maskPattern = maskPattern != -1 ? maskPattern : ChooseMaskPattern(finalBits, ecLevel, *version);
 
 	// Build the matrix and set it to "qrCode".
 	BuildMatrix(finalBits, ecLevel, *version, output.maskPattern, matrix);
@@ -15,7 +15,11 @@ namespace ZXing::QRCode {
 enum class ErrorCorrectionLevel;
 class EncodeResult;
 
+/**
+* Encode the content into a QR Code symbol. If optimizeSegments is set, the content is split into the sequence of
+* numeric, alphanumeric, byte and Kanji segments that results in the smallest symbol, otherwise a single mode is used.
+*/
 EncodeResult Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, CharacterSet encoding, int versionNumber,
-					bool useGs1Format, int maskPattern = -1);
+					bool useGs1Format, int maskPattern = -1, bool optimizeSegments = false);
 
 } // namespace ZXing::QRCode
@@ -6,6 +6,9 @@
 
 #include "QRMaskUtil.h"
 
+#include "BitHacks.h"
+#include "QRDataMask.h"
+
 #include <algorithm>
 #include <array>
 #include <cassert>
@@ -151,4 +154,140 @@ int CalculateMaskPenalty(const TritMatrix& matrix)
 		   + MaskUtil::ApplyMaskPenaltyRule4(matrix);
 }
 
+// Bit-packed implementation ===================================================
+
+using Line = PackedMatrix::Line;
+
+// bit i of the result is bit i + n of l (n < 32), i.e. 'looking n modules ahead'
+static Line operator>>(const Line& l, int n)
+{
+	Line res;
+	for (int i = 0; i < Size(l); ++i)
+		res[i] = (l[i] >> n) | (n && i + 1 < Size(l) ? l[i + 1] << (32 - n) : 0);
+	return res;
+}
+
+// bit i of the result is bit i - n of l (n < 32), i.e. 'looking n modules back', zeros are shifted in
+static Line operator<<(const Line& l, int n)
+{
+	Line res;
+	for (int i = 0; i < Size(l); ++i)
+		res[i] = (l[i] << n) | (n && i > 0 ? l[i - 1] >> (32 - n) : 0);
+	return res;
+}
+
+#define ZX_LINE_OP(OP) \
+	static Line operator OP(Line a, const Line& b) \
+	{ \
+		for (int i = 0; i < Size(a); ++i) \
+			a[i] OP##= b[i]; \
+		return a; \
+	}
+
+ZX_LINE_OP(&)
+ZX_LINE_OP(|)
+ZX_LINE_OP(^)
+
+#undef ZX_LINE_OP
+
+static Line operator~(Line a)
+{
+	for (auto& w : a)
+		w = ~w;
+	return a;
+}
+
+static int CountBitsSet(const Line& l)
+{
+	int res = 0;
+	for (auto w : l)
+		res += BitHacks::CountBitsSet(w);
+	return res;
+}
+
+// line with the bits [0, n) set
+static Line FirstBits(int n)
+{
+	Line res = {};
+	for (int i = 0; i < n; ++i)
+		res[i / 32] |= uint32_t(1) << (i % 32);
+	return res;
+}
+
+PackedMatrix::PackedMatrix(const TritMatrix& matrix) : PackedMatrix(matrix.width())
+{
+	for (int y = 0; y < _dimension; ++y)
+		for (int x = 0; x < _dimension; ++x)
+			if (matrix.get(x, y))
+				set(x, y, true);
+}
+
+PackedMatrix PackedMatrix::masked(int maskPattern, const PackedMatrix& region) const
+{
+	// all data masks are periodic with a period dividing 12 in both directions
+	constexpr int PERIOD = 12;
+	Line maskRows[PERIOD] = {}, maskCols[PERIOD] = {};
+	for (int i = 0; i < PERIOD; ++i)
+		for (int j = 0; j < _dimension; ++j) {
+			if (GetDataMaskBit(maskPattern, j, i))
+				maskRows[i][j / 32] |= uint32_t(1) << (j % 32);
+			if (GetDataMaskBit(maskPattern, i, j))
+				maskCols[i][j / 32] |= uint32_t(1) << (j % 32);
+		}
+
+	PackedMatrix res(_dimension);
+	for (int i = 0; i < _dimension; ++i) {
+		res._rows[i] = _rows[i] ^ (maskRows[i % PERIOD] & region._rows[i]);
+		res._cols[i] = _cols[i] ^ (maskCols[i % PERIOD] & region._cols[i]);
+	}
+	return res;
+}
+
+// rule 1: a run of L >= 5 same colored modules costs N1 + L - 5. With w marking the positions that start 5 same
+// colored modules, a run contributes L - 4 bits to w and one start of a run of bits in w.
+static int PenaltyRule1(const Line& line, const Line& pairs)
+{
+	auto same = ~(line ^ (line >> 1)) & pairs;
+	auto w = same & (same >> 1) & (same >> 2) & (same >> 3);
+	return CountBitsSet(w) + (N1 - 1) * CountBitsSet(w & ~(w << 1));
+}
+
+// rule 2: 2x2 blocks of the same color in the rows a and b = a + 1
+static int PenaltyRule2(const Line& a, const Line& b, const Line& pairs)
+{
+	return N2 * CountBitsSet(~(a ^ b) & ~(a ^ (a >> 1)) & ~(b ^ (b >> 1)) & pairs);
+}
+
+// rule 3: 1:1:3:1:1 finder like patterns with 4 light modules before or after (the outside of the symbol is light)
+static int PenaltyRule3(const Line& line, const Line& valid)
+{
+	auto finder = line & ~(line >> 1) & (line >> 2) & (line >> 3) & (line >> 4) & ~(line >> 5) & (line >> 6) & valid;
+	auto lightAfter = ~((line >> 7) | (line >> 8) | (line >> 9) | (line >> 10));
+	auto lightBefore = ~((line << 1) | (line << 2) | (line << 3) | (line << 4));
+	return N3 * CountBitsSet(finder & (lightAfter | lightBefore));
+}
+
+int CalculateMaskPenalty(const PackedMatrix& matrix)
+{
+	const int n = matrix.width();
+	const auto valid = FirstBits(n), pairs = FirstBits(n - 1);
+
+	int penalty = 0, numDarkCells = 0;
+	for (int i = 0; i < n; ++i) {
+		const auto& row = matrix.row(i);
+		const auto& col = matrix.column(i);
+		penalty += PenaltyRule1(row, pairs) + PenaltyRule1(col, pairs);
+		penalty += PenaltyRule3(row, valid) + PenaltyRule3(col, valid);
+		if (i + 1 < n)
+			penalty += PenaltyRule2(row, matrix.row(i + 1), pairs);
+		numDarkCells += CountBitsSet(row);
+	}
+
+	// rule 4, see ApplyMaskPenaltyRule4
+	int numTotalCells = n * n;
+	penalty += std::abs(numDarkCells * 2 - numTotalCells) * 10 / numTotalCells * N4;
+
+	return penalty;
+}
+
 } // namespace ZXing::QRCode::MaskUtil
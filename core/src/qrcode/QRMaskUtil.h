@@ -6,10 +6,59 @@
 
 #pragma once
 
+#include "Point.h"
 #include "TritMatrix.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 namespace ZXing::QRCode::MaskUtil {
 
+/**
+ * Bit-packed square module matrix (dark modules are 1) that is stored row-wise and column-wise, so the penalty rules
+ * can be evaluated in both directions with word-parallel bit operations.
+ */
+class PackedMatrix
+{
+public:
+	static constexpr int MAX_DIMENSION = 177; // version 40
+	using Line = std::array<uint32_t, (MAX_DIMENSION + 31) / 32>;
+
+	explicit PackedMatrix(int dimension) : _dimension(dimension), _rows(dimension), _cols(dimension) {}
+	explicit PackedMatrix(const TritMatrix& matrix);
+
+	int width() const { return _dimension; }
+	int height() const { return _dimension; }
+
+	bool get(int x, int y) const { return (_rows[y][x / 32] >> (x % 32)) & 1; }
+	void set(int x, int y, bool v)
+	{
+		SetBit(_rows[y], x, v);
+		SetBit(_cols[x], y, v);
+	}
+	void set(PointI p, bool v) { set(p.x, p.y, v); }
+
+	const Line& row(int y) const { return _rows[y]; }
+	const Line& column(int x) const { return _cols[x]; }
+
+	/// Copy of this matrix with the data mask maskPattern applied to all modules set in region
+	PackedMatrix masked(int maskPattern, const PackedMatrix& region) const;
+
+private:
+	int _dimension;
+	std::vector<Line> _rows, _cols;
+
+	static void SetBit(Line& line, int i, bool v)
+	{
+		uint32_t bit = uint32_t(1) << (i % 32);
+		line[i / 32] = v ? line[i / 32] | bit : line[i / 32] & ~bit;
+	}
+};
+
 int CalculateMaskPenalty(const TritMatrix& matrix);
 
+/// Same result as the TritMatrix version but computed with popcounts over bit-parallel pattern matches
+int CalculateMaskPenalty(const PackedMatrix& matrix);
+
 } // namespace ZXing::QRCode::MaskUtil
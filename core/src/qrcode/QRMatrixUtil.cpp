@@ -10,8 +10,10 @@
 #include "BitHacks.h"
 #include "QRDataMask.h"
 #include "QRErrorCorrectionLevel.h"
+#include "QRMaskUtil.h"
 #include "QRVersion.h"
 
+#include <limits>
 #include <stdexcept>
 #include <string>
 
@@ -181,7 +183,8 @@ static BitArray MakeTypeInfoBits(ErrorCorrectionLevel ecLevel, int maskPattern)
 }
 
 // Embed type information. On success, modify the matrix.
-static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, TritMatrix& matrix)
+template <typename MATRIX>
+static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, MATRIX& matrix)
 {
 	// Type info cells at the left top corner.
 	constexpr PointI TYPE_INFO_COORDINATES[] = {
@@ -294,9 +297,8 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 	}
 }
 
-// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
-// success, store the result in "matrix" and return true.
-void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+// Embed everything but the data bits.
+static void EmbedFunctionPatterns(ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
 {
 	matrix.clear();
 	// Let's get started with embedding big squares at corners.
@@ -311,8 +313,44 @@ void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const V
 	EmbedTypeInfo(ecLevel, maskPattern, matrix);
 	// Version info appear if version >= 7.
 	EmbedVersionInfo(version, matrix);
+}
+
+// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
+// success, store the result in "matrix" and return true.
+void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+{
+	EmbedFunctionPatterns(ecLevel, version, maskPattern, matrix);
 	// Data should be embedded at end.
 	EmbedDataBits(dataBits, maskPattern, matrix);
 }
 
+int ChooseMaskPattern(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version)
+{
+	// place everything once, the type info of mask 0 is only a placeholder to keep the data bits out of its modules
+	TritMatrix matrix(version.dimension(), version.dimension());
+	EmbedFunctionPatterns(ecLevel, version, 0, matrix);
+
+	MaskUtil::PackedMatrix isData(matrix.width());
+	for (int y = 0; y < matrix.height(); ++y)
+		for (int x = 0; x < matrix.width(); ++x)
+			if (matrix.get(x, y).isEmpty())
+				isData.set(x, y, true);
+
+	EmbedDataBits(dataBits, -1, matrix);
+	const MaskUtil::PackedMatrix unmasked(matrix);
+
+	int minPenalty = std::numeric_limits<int>::max(); // Lower penalty is better.
+	int bestMaskPattern = -1;
+	for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; maskPattern++) {
+		auto masked = unmasked.masked(maskPattern, isData);
+		EmbedTypeInfo(ecLevel, maskPattern, masked);
+		int penalty = MaskUtil::CalculateMaskPenalty(masked);
+		if (penalty < minPenalty) {
+			minPenalty = penalty;
+			bestMaskPattern = maskPattern;
+		}
+	}
+	return bestMaskPattern;
+}
+
 } // namespace ZXing::QRCode
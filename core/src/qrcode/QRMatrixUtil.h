@@ -21,5 +21,11 @@ constexpr int NUM_MASK_PATTERNS = 8;
 
 void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
 
+/**
+ * Choose the mask pattern with the lowest penalty (see MaskUtil::CalculateMaskPenalty). Function patterns and data bits
+ * are placed only once, the masks are applied to a bit-packed copy of the matrix.
+ */
+int ChooseMaskPattern(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version);
+
 } // QRCode
 } // ZXing
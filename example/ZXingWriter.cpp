@@ -206,7 +206,9 @@ int main(int argc, char* argv[])
 			success = stbi_write_jpg(cli.outPath.c_str(), bitmap.width(), bitmap.height(), 1, bitmap.data(), 0);
 		} else if (ext == "svg") {
 #ifdef ZXING_EXPERIMENTAL_API
-			success = (std::ofstream(cli.outPath) << WriteBarcodeToSVG(barcode, wOpts)).good();
+			std::ofstream file(cli.outPath);
+			WriteBarcodeToSVG(barcode, file, wOpts);
+			success = file.good();
 #else
 			success = (std::ofstream(cli.outPath) << ToSVG(matrix)).good();
 #endif
@@ -0,0 +1,97 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Barcode.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
+#include "ECI.h"
+
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ZXing;
+
+static Barcode MakeBarcode(const std::string& text, StructuredAppendInfo sai = {})
+{
+	Content content;
+	content.symbology = {'Q', '1', 1};
+	content.switchEncoding(ECI::UTF8);
+	content.append(text);
+	return Barcode(DecoderResult(std::move(content)).setStructuredAppend(sai), DetectorResult({}, Rectangle<PointI>(10, 10)),
+				   BarcodeFormat::QRCode);
+}
+
+TEST(BarcodeTest, TextView)
+{
+	auto barcode = MakeBarcode("A\x1D\\B");
+
+	EXPECT_EQ(barcode.textView(TextMode::Plain), "A\x1D\\B");
+	EXPECT_EQ(barcode.textView(TextMode::ECI), "]Q2\\000026A\x1D\\\\B");
+	EXPECT_EQ(barcode.textView(TextMode::Hex), "41 1D 5C 42");
+	EXPECT_EQ(barcode.textView(TextMode::Escaped), "A<GS>\\B");
+	EXPECT_EQ(barcode.text(TextMode::Escaped), "A<GS>\\B");
+	EXPECT_EQ(barcode.contentType(), ContentType::Binary); // because of the <GS>
+
+	// the text is rendered only once and shared between copies
+	auto view = barcode.textView(TextMode::Plain);
+	EXPECT_EQ(barcode.textView(TextMode::Plain).data(), view.data());
+	auto copy = barcode;
+	barcode = Barcode();
+	EXPECT_EQ(copy.textView(TextMode::Plain).data(), view.data());
+	EXPECT_EQ(view, "A\x1D\\B");
+
+	EXPECT_EQ(Barcode().textView(TextMode::Plain), "");
+	EXPECT_EQ(Barcode().text(TextMode::Hex), "");
+}
+
+TEST(BarcodeTest, TextViewConcurrent)
+{
+	auto barcode = MakeBarcode("concurrent");
+
+	std::vector<std::thread> threads;
+	std::vector<const char*> views(8);
+	for (int i = 0; i < Size(views); ++i)
+		threads.emplace_back([&, i] { views[i] = barcode.textView(TextMode::Plain).data(); });
+	for (auto& thread : threads)
+		thread.join();
+
+	for (auto view : views)
+		EXPECT_EQ(view, views.front());
+	EXPECT_EQ(barcode.text(), "concurrent");
+}
+
+TEST(BarcodeTest, TextViewAfterMerge)
+{
+	auto a = MakeBarcode("A", {0, 2, "1"});
+	EXPECT_EQ(a.textView(), "A");
+
+	auto merged = MergeStructuredAppendSequence({a, MakeBarcode("B", {1, 2, "1"})});
+	EXPECT_EQ(merged.textView(), "AB");
+	EXPECT_EQ(a.textView(), "A");
+}
+
+TEST(BarcodeTest, GS1Elements)
+{
+	Content content;
+	content.symbology = {'d', '2', 3, AIFlag::GS1};
+	content.append("0101234567890128" "10ABC\x1D" "17241231");
+	auto barcode = Barcode(DecoderResult(std::move(content)), DetectorResult({}, Rectangle<PointI>(10, 10)),
+						   BarcodeFormat::DataMatrix);
+
+	auto elements = barcode.gs1Elements();
+	ASSERT_EQ(elements.size(), 3);
+	EXPECT_EQ(elements[1].ai, "10");
+	EXPECT_EQ(elements[1].value, "ABC");
+	EXPECT_EQ(elements[1].value.data(), reinterpret_cast<const char*>(barcode.bytes().data()) + 18);
+	EXPECT_EQ(barcode.text(TextMode::HRI), "(01)01234567890128(10)ABC(17)241231");
+
+	// a copy shares the text cache, but its elements point into its own bytes
+	auto copy = barcode;
+	EXPECT_EQ(copy.gs1Elements()[1].value.data(), reinterpret_cast<const char*>(copy.bytes().data()) + 18);
+
+	EXPECT_TRUE(MakeBarcode("0101234567890128").gs1Elements().empty()); // not GS1
+}
@@ -344,3 +344,25 @@ TEST(HRIFromGS1, MultiVariable)
 {
 	EXPECT_EQ(HRIFromGS1("70041234\x1d""81111234"), "(7004)1234(8111)1234");
 }
+
+TEST(HRIFromGS1, Elements)
+{
+	std::string_view gs1 = "0101234567890128" "3103000123" "10ABC123\x1D" "17241231";
+	auto elements = GS1Elements(gs1);
+	ASSERT_EQ(elements.size(), 4);
+	EXPECT_EQ(elements[0].ai, "01");
+	EXPECT_EQ(elements[0].value, "01234567890128");
+	EXPECT_EQ(elements[1].ai, "3103");
+	EXPECT_EQ(elements[1].value, "000123");
+	EXPECT_EQ(elements[2].ai, "10");
+	EXPECT_EQ(elements[2].value, "ABC123");
+	EXPECT_EQ(elements[3].ai, "17");
+	EXPECT_EQ(elements[3].value, "241231");
+
+	// the views point into the input
+	EXPECT_EQ(elements[2].value.data(), gs1.data() + 28);
+
+	EXPECT_TRUE(GS1Elements("").empty());
+	EXPECT_TRUE(GS1Elements("0101234567890128" "14").empty()); // unknown AI
+	EXPECT_TRUE(GS1Elements("3101").empty()); // incomplete 4 digit AI
+}
@@ -0,0 +1,103 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Barcode.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
+
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace ZXing;
+
+static Barcode Part(const std::string& text, int index, int count, const std::string& id = "1")
+{
+	Content content;
+	content.symbology = {'Q', '1', 1};
+	content.append(text);
+	return Barcode(DecoderResult(std::move(content)).setStructuredAppend({index, count, id}),
+				   DetectorResult({}, Rectangle<PointI>(10, 10)), BarcodeFormat::QRCode);
+}
+
+TEST(StructuredAppendTest, MergeSequences)
+{
+	auto res = MergeStructuredAppendSequences({Part("C", 2, 3), Part("x", 0, 1, "2"), Part("A", 0, 3), Part("B", 1, 3)});
+	ASSERT_EQ(Size(res), 2);
+	EXPECT_EQ(res[0].text(), "ABC");
+	EXPECT_EQ(res[0].sequenceIndex(), -1);
+	EXPECT_EQ(res[0].sequenceSize(), 3);
+	EXPECT_EQ(res[0].position(), Position{});
+	EXPECT_EQ(res[1].text(), "x");
+
+	// incomplete sequences are dropped
+	EXPECT_TRUE(MergeStructuredAppendSequences({Part("A", 0, 3), Part("C", 2, 3)}).empty());
+}
+
+TEST(StructuredAppendTest, AssemblerIncremental)
+{
+	StructuredAppendAssembler assembler;
+
+	EXPECT_FALSE(assembler.add(Barcode()));
+	EXPECT_TRUE(assembler.add(Part("B", 1, 3)));
+	EXPECT_FALSE(assembler.isComplete("1"));
+	EXPECT_FALSE(assembler.merge("1").isValid());
+
+	// the next 'frame' contains the same part again and a new one
+	EXPECT_EQ(assembler.add(Barcodes{Part("B", 1, 3), Part("C", 2, 3)}), 1);
+	EXPECT_EQ(assembler.partCount("1"), 2);
+	EXPECT_TRUE(assembler.completeSequenceIds().empty());
+
+	EXPECT_TRUE(assembler.add(Part("A", 0, 3)));
+	EXPECT_TRUE(assembler.isComplete("1"));
+	EXPECT_EQ(assembler.completeSequenceIds(), std::vector<std::string>{"1"});
+
+	auto merged = assembler.merge("1");
+	EXPECT_TRUE(merged.isValid());
+	EXPECT_EQ(merged.text(), "ABC");
+	EXPECT_EQ(merged.format(), BarcodeFormat::QRCode);
+	EXPECT_EQ(merged.symbologyIdentifier(), "]Q1");
+	EXPECT_TRUE(assembler.empty());
+}
+
+TEST(StructuredAppendTest, AssemblerUnknownCount)
+{
+	// PDF417 sequences without the optional segment count only know their size once the last segment is seen
+	StructuredAppendAssembler assembler;
+	assembler.add(Part("A", 0, 0));
+	assembler.add(Part("B", 1, 0));
+	EXPECT_FALSE(assembler.isComplete("1"));
+
+	assembler.add(Part("C", 2, 3));
+	EXPECT_TRUE(assembler.isComplete("1"));
+	EXPECT_EQ(assembler.merge("1").text(), "ABC");
+}
+
+TEST(StructuredAppendTest, AssemblerMismatch)
+{
+	StructuredAppendAssembler assembler;
+
+	// the index is taken from the symbol, a huge one must not make the assembler allocate a part for each index below
+	EXPECT_TRUE(assembler.add(Part("X", 99998, 0)));
+	EXPECT_EQ(assembler.partCount("1"), 1);
+	EXPECT_FALSE(assembler.isComplete("1"));
+
+	// the last part reveals the size, which is smaller than the index of the part above
+	EXPECT_TRUE(assembler.add(Part("A", 1, 2)));
+	EXPECT_TRUE(assembler.isComplete("1"));
+	auto merged = assembler.merge("1");
+	EXPECT_FALSE(merged.isValid());
+	EXPECT_EQ(merged.error().type(), Error::Type::Format);
+	EXPECT_TRUE(assembler.empty());
+
+	// index >= count with the count known up front
+	assembler.add(Barcodes{Part("A", 0, 2), Part("B", 1, 2), Part("C", 2, 2)});
+	EXPECT_EQ(assembler.merge("1").error().type(), Error::Type::Format);
+
+	// parts that disagree about the size of the sequence
+	assembler.add(Barcodes{Part("A", 0, 2), Part("B", 1, 3)});
+	EXPECT_EQ(assembler.merge("1").error().type(), Error::Type::Format);
+
+	EXPECT_TRUE(MergeStructuredAppendSequences({Part("A", 0, 2), Part("B", 1, 2), Part("C", 2, 2)}).empty());
+}
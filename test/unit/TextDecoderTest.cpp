@@ -248,3 +248,60 @@ TEST(TextDecoderTest, AppendUTF16BE)
 		EXPECT_EQ(ToUtf8(str), "𐀀");
 	}
 }
+
+TEST(TextDecoderTest, AppendUTF8)
+{
+	auto append = [](std::string_view in, CharacterSet cs = CharacterSet::UTF8, bool sjisASCII = true) {
+		std::string str = "x";
+		TextDecoder::Append(str, reinterpret_cast<const uint8_t*>(in.data()), in.size(), cs, sjisASCII);
+		return str;
+	};
+
+	// long enough to cover the word-wise ASCII scan and its tail
+	std::string ascii = "The quick brown fox jumps over the lazy dog 0123456789\t\r\n";
+	EXPECT_EQ(append(ascii), "x" + ascii);
+	EXPECT_EQ(append(ascii + "\xC3\xA4"), "x" + ascii + "ä");
+	EXPECT_EQ(append(ascii, CharacterSet::ISO8859_1), "x" + ascii);
+	EXPECT_EQ(append(ascii, CharacterSet::Shift_JIS), "x" + ascii);
+
+	EXPECT_EQ(append("\xE2\x82\xAC \xF0\x9F\x98\x80 \xED\x9F\xBF \xF4\x8F\xBF\xBF"), "x€ 😀 ퟿ \U0010FFFF");
+
+	// invalid: overlong, surrogate, above U+10FFFF, truncated and stray continuation byte
+	EXPECT_EQ(append("a\xC0\xAF"), "xa\xEF\xBF\xBD");
+	EXPECT_EQ(append("a\xED\xA0\x80"), "xa\xEF\xBF\xBD");
+	EXPECT_EQ(append("a\xF4\x90\x80\x80").substr(0, 5), "xa\xEF\xBF\xBD");
+	EXPECT_EQ(append("a\xE2\x82"), "xa\xEF\xBF\xBD");
+	EXPECT_EQ(append("a\x80z"), "xa\xEF\xBF\xBDz");
+
+	// ASCII is not passed straight through where it is mapped differently
+	EXPECT_EQ(append("\\~", CharacterSet::Shift_JIS, false), "x¥‾");
+	EXPECT_EQ(append("ab", CharacterSet::UTF16BE), "x慢");
+}
+
+TEST(TextDecoderTest, GuessEncodingASCII)
+{
+	std::string ascii = "The quick brown fox jumps over the lazy dog 0123456789";
+	auto bytes = reinterpret_cast<const uint8_t*>(ascii.data());
+	EXPECT_EQ(TextDecoder::GuessEncoding(bytes, ascii.size()), CharacterSet::ISO8859_1);
+	EXPECT_EQ(TextDecoder::GuessEncoding(bytes, ascii.size(), CharacterSet::Shift_JIS), CharacterSet::Shift_JIS);
+	ascii += "\xC3\xA4";
+	EXPECT_EQ(TextDecoder::GuessEncoding(reinterpret_cast<const uint8_t*>(ascii.data()), ascii.size()), CharacterSet::UTF8);
+}
+
+TEST(TextDecoderTest, GuessEncodingIsUtf8)
+{
+	auto guess = [](std::string_view in, CharacterSet fallback = CharacterSet::ISO8859_1) {
+		bool isUtf8 = false;
+		auto cs = TextDecoder::GuessEncoding(reinterpret_cast<const uint8_t*>(in.data()), in.size(), fallback, isUtf8);
+		return std::pair{cs, isUtf8};
+	};
+
+	EXPECT_EQ(guess("ASCII only"), std::pair(CharacterSet::ISO8859_1, true));
+	EXPECT_EQ(guess("ASCII only", CharacterSet::Shift_JIS), std::pair(CharacterSet::Shift_JIS, false));
+	EXPECT_EQ(guess("\xC3\xA4 \xE2\x82\xAC \xF0\x9F\x98\x80"), std::pair(CharacterSet::UTF8, true));
+	EXPECT_EQ(guess("caf\xE9"), std::pair(CharacterSet::ISO8859_1, false));
+
+	// structurally UTF-8, but overlong, a surrogate, above U+10FFFF resp. a lead byte instead of a continuation byte
+	for (std::string_view in : {"a\xC0\xAF", "a\xED\xA0\x80", "a\xF4\x90\x80\x80", "a\xC3\xC3"})
+		EXPECT_EQ(guess(in), std::pair(CharacterSet::UTF8, false)) << in;
+}
@@ -0,0 +1,501 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrix.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
+#include "ReadBarcode.h"
+#include "WriteBarcode.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ZXing;
+
+static Barcode Create(BarcodeFormat format, const std::string& text, bool verify, const std::string& ecLevel = {})
+{
+	return CreateBarcodeFromText(text, CreatorOptions(format).verify(verify).ecLevel(ecLevel));
+}
+
+static Barcode ReadImage(const ImageView& image, BarcodeFormat format)
+{
+	return ReadBarcode(image, ReaderOptions().setFormats(format).setTryHarder(false));
+}
+
+TEST(WriteBarcodeTest, RoundTrip)
+{
+	for (auto format : {BarcodeFormat::Aztec, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417, BarcodeFormat::QRCode,
+						BarcodeFormat::Code128, BarcodeFormat::EAN13}) {
+		std::string text = format == BarcodeFormat::EAN13 ? "4006381333931" : "Hello World 123";
+		for (bool verify : {false, true}) {
+			auto barcode = Create(format, text, verify);
+			auto image = WriteBarcodeToImage(barcode, WriterOptions().sizeHint(200));
+			auto res = ReadImage(image, format);
+			EXPECT_TRUE(res.isValid()) << ToString(format) << verify;
+			EXPECT_EQ(res.text(), text) << ToString(format) << verify;
+		}
+	}
+}
+
+TEST(WriteBarcodeTest, SymbolPolarity)
+{
+	for (auto format : {BarcodeFormat::Aztec, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417, BarcodeFormat::QRCode}) {
+		auto plain = Create(format, "POLARITY", false);
+		auto verified = Create(format, "POLARITY", true);
+
+		auto a = plain.symbol(), b = verified.symbol();
+		ASSERT_TRUE(a.data() && b.data()) << ToString(format);
+		ASSERT_EQ(a.width(), b.width()) << ToString(format);
+		ASSERT_EQ(a.height(), b.height()) << ToString(format);
+		for (int y = 0; y < a.height(); ++y)
+			for (int x = 0; x < a.width(); ++x)
+				ASSERT_EQ(*a.data(x, y), *b.data(x, y)) << ToString(format) << " " << x << "," << y;
+
+		// the symbol is an image: dark modules are black, light ones white
+		EXPECT_TRUE(Contains({0, 255}, *a.data(0, 0))) << ToString(format);
+		// the symbol of a reader result has the same polarity
+		auto read = ReadImage(WriteBarcodeToImage(plain, WriterOptions().sizeHint(200)), format);
+		if (format != BarcodeFormat::PDF417) { // the PDF417 reader provides no module matrix
+			EXPECT_EQ(*read.symbol().data(0, 0), *a.data(0, 0)) << ToString(format);
+		}
+	}
+
+	// the top left module of QR Code and DataMatrix is dark
+	EXPECT_EQ(*Create(BarcodeFormat::QRCode, "A", false).symbol().data(0, 0), 0);
+	EXPECT_EQ(*Create(BarcodeFormat::DataMatrix, "A", false).symbol().data(0, 0), 0);
+}
+
+TEST(WriteBarcodeTest, MetaData)
+{
+	for (auto format : {BarcodeFormat::Aztec, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417, BarcodeFormat::QRCode}) {
+		for (std::string text : {std::string("A"), std::string("Hello World 123"), std::string(300, 'x')}) {
+			for (std::string ecLevel : {"", "2", "6"}) {
+				if (format == BarcodeFormat::DataMatrix && !ecLevel.empty())
+					continue;
+				auto plain = Create(format, text, false, ecLevel);
+				auto verified = Create(format, text, true, ecLevel);
+				EXPECT_EQ(plain.ecLevel(), verified.ecLevel()) << ToString(format) << text.size() << ecLevel;
+				EXPECT_EQ(plain.version(), verified.version()) << ToString(format) << text.size() << ecLevel;
+			}
+		}
+	}
+
+	EXPECT_EQ(Create(BarcodeFormat::QRCode, "A", false).ecLevel(), "L");
+	EXPECT_EQ(Create(BarcodeFormat::QRCode, "A", false).version(), "1");
+	EXPECT_EQ(Create(BarcodeFormat::QRCode, "A", false, "8").ecLevel(), "H");
+	EXPECT_EQ(Create(BarcodeFormat::DataMatrix, "A", false).version(), "1");
+	EXPECT_EQ(Create(BarcodeFormat::DataMatrix, std::string(100, '7'), false).version(), "10"); // 32x32
+	EXPECT_EQ(Create(BarcodeFormat::Aztec, "A", false).version(), "1");
+	EXPECT_FALSE(Create(BarcodeFormat::PDF417, "A", false).ecLevel().empty());
+}
+
+TEST(WriteBarcodeTest, MinimalDataMatrix)
+{
+	auto opts = CreatorOptions(BarcodeFormat::DataMatrix).forceSquareDataMatrix(true);
+	EXPECT_FALSE(opts.minimalDataMatrix());
+	EXPECT_EQ(CreateBarcodeFromText("ABCDEFGHIJ.abcdefghij", opts).symbol().width(), 20);
+	EXPECT_EQ(CreateBarcodeFromText("ABCDEFGHIJ.abcdefghij", opts.minimalDataMatrix(true)).symbol().width(), 18);
+}
+
+TEST(WriteBarcodeTest, Content)
+{
+	// the bytes and ECI are the ones stored in the symbol, e.g. "é" is ISO-8859-1 encoded, not UTF-8
+	for (auto format : {BarcodeFormat::Aztec, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417, BarcodeFormat::QRCode}) {
+		for (std::string text : {"Hello World 123", "caf\u00e9"}) {
+			auto plain = Create(format, text, false);
+			auto verified = Create(format, text, true);
+			EXPECT_EQ(plain.bytes(), verified.bytes()) << ToString(format) << text;
+			EXPECT_EQ(plain.bytesECI(), verified.bytesECI()) << ToString(format) << text;
+			EXPECT_EQ(plain.hasECI(), verified.hasECI()) << ToString(format) << text;
+			EXPECT_EQ(plain.text(), text) << ToString(format) << text;
+		}
+	}
+	EXPECT_EQ(Create(BarcodeFormat::QRCode, "caf\u00e9", false).bytes(), ByteArray({'c', 'a', 'f', 0xE9}));
+
+	for (auto format : {BarcodeFormat::Aztec, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417, BarcodeFormat::QRCode}) {
+		for (std::string data : {std::string("\x01\x80\xFF"), std::string("1234")}) {
+			auto opts = CreatorOptions(format);
+			auto plain = CreateBarcodeFromBytes(data.data(), Size(data), opts);
+			auto verified = CreateBarcodeFromBytes(data.data(), Size(data), opts.verify(true));
+			EXPECT_EQ(plain.bytes(), verified.bytes()) << ToString(format);
+			EXPECT_EQ(plain.bytesECI(), verified.bytesECI()) << ToString(format);
+			EXPECT_EQ(plain.hasECI(), verified.hasECI()) << ToString(format);
+		}
+	}
+}
+
+TEST(WriteBarcodeTest, CreateBarcodesFromText)
+{
+	std::vector<std::string> texts;
+	for (int i = 0; i < 20; ++i)
+		texts.push_back("BATCH " + std::to_string(i * 7919));
+
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::DataMatrix, BarcodeFormat::Code128}) {
+		for (int threads : {1, 3}) {
+			auto opts = CreatorOptions(format).maxThreadCount(threads);
+			auto res = CreateBarcodesFromText(texts, opts);
+			ASSERT_EQ(Size(res), Size(texts));
+			for (int i = 0; i < Size(texts); ++i) {
+				auto single = CreateBarcodeFromText(texts[i], opts);
+				EXPECT_EQ(res[i].text(), texts[i]) << ToString(format) << threads;
+				EXPECT_EQ(res[i].format(), format);
+				EXPECT_EQ(res[i].ecLevel(), single.ecLevel());
+				EXPECT_EQ(res[i].version(), single.version());
+				// batch results are rendered exactly like single ones, human readable text included
+				for (bool withHRT : {false, true}) {
+					auto wopts = WriterOptions().withHRT(withHRT);
+					EXPECT_EQ(WriteBarcodeToSVG(res[i], wopts), WriteBarcodeToSVG(single, wopts)) << ToString(format) << i;
+				}
+			}
+		}
+	}
+
+	EXPECT_TRUE(CreateBarcodesFromText(std::vector<std::string>{}, CreatorOptions(BarcodeFormat::QRCode)).empty());
+
+	// the first error is rethrown after all threads are done
+	texts[7] = "not a number";
+	EXPECT_ANY_THROW(CreateBarcodesFromText(texts, CreatorOptions(BarcodeFormat::EAN13).maxThreadCount(4)));
+}
+
+TEST(WriteBarcodeTest, RenderConcurrently)
+{
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::Code128}) {
+		const auto barcode = CreateBarcodeFromText("RENDER ME", CreatorOptions(format));
+		const int sizes[] = {50, 100, 200, 400};
+
+		std::vector<Image> images;
+		std::vector<std::string> svgs;
+		for (int size : sizes) {
+			images.push_back(WriteBarcodeToImage(barcode, WriterOptions().sizeHint(size)));
+			svgs.push_back(WriteBarcodeToSVG(barcode, WriterOptions().sizeHint(size).withHRT(true)));
+		}
+
+		// rendering does not modify the Barcode, the same one can be rendered at different sizes at the same time
+		std::vector<std::thread> threads;
+		std::atomic<int> mismatches = 0;
+		for (int t = 0; t < 4; ++t)
+			threads.emplace_back([&] {
+				for (int n = 0; n < 10; ++n)
+					for (int i = 0; i < Size(sizes); ++i) {
+						auto image = WriteBarcodeToImage(barcode, WriterOptions().sizeHint(sizes[i]));
+						if (image.width() != images[i].width() || image.height() != images[i].height()
+							|| !std::equal(image.data(), image.data() + image.width() * image.height(), images[i].data()))
+							++mismatches;
+						if (WriteBarcodeToSVG(barcode, WriterOptions().sizeHint(sizes[i]).withHRT(true)) != svgs[i])
+							++mismatches;
+					}
+			});
+		for (auto& thread : threads)
+			thread.join();
+		EXPECT_EQ(mismatches, 0) << ToString(format);
+
+		// and it still renders as before
+		EXPECT_EQ(WriteBarcodeToSVG(barcode, WriterOptions().sizeHint(100).withHRT(true)), svgs[1]);
+		auto res = ReadImage(WriteBarcodeToImage(barcode, WriterOptions().sizeHint(200)), format);
+		EXPECT_EQ(res.text(), "RENDER ME") << ToString(format);
+	}
+}
+
+TEST(WriteBarcodeTest, WriteToBuffer)
+{
+	auto barcode = Create(BarcodeFormat::QRCode, "BUFFER", false);
+	auto symbol = barcode.symbol();
+
+	for (int rotate : {0, 90, 180, 270}) {
+		// an RGB buffer with padded rows, pre-filled with gray
+		const int width = 300, height = 250, rowStride = width * 3 + 5, left = 17, top = 23, scale = 3;
+		std::vector<uint8_t> buffer(height * rowStride, 0x80);
+
+		auto opts = WriterOptions().scale(scale).rotate(rotate).withQuietZones(true);
+		auto region = WriteBarcodeToBuffer(barcode, buffer.data(), width, height, ImageFormat::RGB, rowStride, left, top, opts);
+		ASSERT_EQ(region.width(), symbol.width() * scale) << rotate;
+		ASSERT_EQ(region.height(), symbol.height() * scale) << rotate;
+		EXPECT_EQ(region.data(), buffer.data() + top * rowStride + left * 3) << rotate;
+
+		// every pixel inside the region is the scaled and rotated module, everything else is untouched
+		auto expected = symbol.rotated(rotate);
+		for (int y = 0; y < height; ++y)
+			for (int i = 0; i < rowStride; ++i) {
+				int x = i / 3;
+				bool inside = i < width * 3 && x >= left && x < left + region.width() && y >= top && y < top + region.height();
+				uint8_t px = inside ? *expected.data((x - left) / scale, (y - top) / scale) : 0x80;
+				ASSERT_EQ(buffer[y * rowStride + i], px) << rotate << " " << i << "," << y;
+			}
+
+		auto res = ReadImage(region, BarcodeFormat::QRCode);
+		EXPECT_EQ(res.text(), "BUFFER") << rotate;
+		EXPECT_EQ((res.orientation() + 360) % 360, rotate) << rotate;
+	}
+
+	// a rotation by 90 degrees swaps width and height of non-square symbols
+	auto pdf417 = Create(BarcodeFormat::PDF417, "BUFFER", false);
+	std::vector<uint8_t> buffer(400 * 400);
+	auto region = WriteBarcodeToBuffer(pdf417, buffer.data(), 400, 400, ImageFormat::Lum, 0, 0, 0,
+									   WriterOptions().scale(1).rotate(90).withQuietZones(true));
+	EXPECT_EQ(region.width(), pdf417.symbol().height());
+	EXPECT_EQ(region.height(), pdf417.symbol().width());
+}
+
+TEST(WriteBarcodeTest, WriteToBufferScale)
+{
+	auto barcode = Create(BarcodeFormat::QRCode, "BUFFER", false);
+	auto symbol = barcode.symbol();
+	std::vector<uint8_t> buffer(400 * 400);
+	auto write = [&](WriterOptions opts) {
+		return WriteBarcodeToBuffer(barcode, buffer.data(), 400, 400, ImageFormat::Lum, 0, 0, 0, opts.withQuietZones(true));
+	};
+
+	// the largest integer scale that fits into sizeHint
+	auto region = write(WriterOptions().sizeHint(200));
+	EXPECT_EQ(region.width(), 200 / symbol.width() * symbol.width());
+	EXPECT_EQ(ReadImage(region, BarcodeFormat::QRCode).text(), "BUFFER");
+
+	// at least 1
+	EXPECT_EQ(write(WriterOptions().sizeHint(10)).width(), symbol.width());
+
+	// scale takes precedence over sizeHint
+	EXPECT_EQ(write(WriterOptions().scale(2).sizeHint(200)).width(), 2 * symbol.width());
+
+	// the symbol has to fit into the buffer
+	EXPECT_THROW(write(WriterOptions().scale(20)), std::invalid_argument);
+	EXPECT_THROW(WriteBarcodeToBuffer(barcode, buffer.data(), 400, 400, ImageFormat::Lum, 0, 390, 0), std::invalid_argument);
+	EXPECT_THROW(WriteBarcodeToBuffer(barcode, buffer.data(), 400, 400, ImageFormat::Lum, 0, -1, 0), std::invalid_argument);
+	EXPECT_THROW(WriteBarcodeToBuffer(barcode, nullptr, 400, 400, ImageFormat::Lum, 0, 0, 0), std::invalid_argument);
+}
+
+TEST(WriteBarcodeTest, WriteToBufferFormat)
+{
+	auto barcode = Create(BarcodeFormat::DataMatrix, "BUFFER", false);
+	auto symbol = barcode.symbol();
+
+	for (auto format : {ImageFormat::Lum, ImageFormat::LumA, ImageFormat::RGB, ImageFormat::BGR, ImageFormat::RGBA,
+						ImageFormat::ARGB, ImageFormat::BGRA, ImageFormat::ABGR}) {
+		const int n = PixStride(format);
+		std::vector<uint8_t> buffer(100 * 100 * n, 0x80);
+		auto region = WriteBarcodeToBuffer(barcode, buffer.data(), 100, 100, format, 0, 1, 2,
+										   WriterOptions().scale(2).withQuietZones(true));
+		ASSERT_EQ(region.format(), format);
+
+		// dark and light pixels are opaque black and white
+		const int alpha = n == 2 ? 1 : n == 4 ? 6 - RedIndex(format) - GreenIndex(format) - BlueIndex(format) : -1;
+		for (int y = 0; y < region.height(); ++y)
+			for (int x = 0; x < region.width(); ++x)
+				for (int c = 0; c < n; ++c)
+					ASSERT_EQ(region.data(x, y)[c], c == alpha ? 0xff : *symbol.data(x / 2, y / 2)) << n << " " << x << "," << y;
+
+		EXPECT_EQ(ReadImage(region, BarcodeFormat::DataMatrix).text(), "BUFFER") << n;
+	}
+}
+
+// parse the module grid back from the single path written by the streaming SVG writer
+static std::vector<std::string> ParseSVGPath(const std::string& svg, int& width, int& height)
+{
+	auto viewBox = svg.find("viewBox=\"0 0 ");
+	EXPECT_NE(viewBox, std::string::npos);
+	std::istringstream vb(svg.substr(viewBox + 13));
+	vb >> width >> height;
+
+	std::vector<std::string> rows(height, std::string(width, ' '));
+	auto begin = svg.find(" d=\"") + 4;
+	std::istringstream path(svg.substr(begin, svg.find('"', begin) - begin));
+	int x = 0, y = 0, dx, dy, len, len2;
+	char m, comma, h, v, h2, z;
+	int one;
+	while (path >> m >> dx >> comma >> dy >> h >> len >> v >> one >> h2 >> len2 >> z) {
+		EXPECT_TRUE(m == 'm' && comma == ',' && h == 'h' && v == 'v' && one == 1 && h2 == 'h' && len2 == -len && z == 'z');
+		x += dx, y += dy;
+		for (int i = x; i < x + len; ++i)
+			rows.at(y).at(i) = 'X';
+	}
+	EXPECT_TRUE(path.eof());
+	return rows;
+}
+
+TEST(WriteBarcodeTest, SVGPath)
+{
+	for (auto format : {BarcodeFormat::QRCode, BarcodeFormat::DataMatrix, BarcodeFormat::PDF417}) {
+		auto barcode = Create(format, "SVG PATH", false);
+		auto symbol = barcode.symbol();
+
+		for (int rotate : {0, 90}) {
+			std::ostringstream out;
+			WriteBarcodeToSVG(barcode, out, WriterOptions().rotate(rotate).withQuietZones(true));
+			int width = 0, height = 0;
+			auto rows = ParseSVGPath(out.str(), width, height);
+
+			auto expected = symbol.rotated(rotate);
+			ASSERT_EQ(width, expected.width()) << ToString(format) << rotate;
+			ASSERT_EQ(height, expected.height()) << ToString(format) << rotate;
+			for (int y = 0; y < height; ++y)
+				for (int x = 0; x < width; ++x)
+					ASSERT_EQ(rows[y][x] == 'X', *expected.data(x, y) == 0) << ToString(format) << rotate << " " << x << "," << y;
+		}
+	}
+}
+
+TEST(WriteBarcodeTest, SVGSize)
+{
+	auto barcode = Create(BarcodeFormat::QRCode, "SVG SIZE", false);
+	const int size = barcode.symbol().width();
+	auto svg = [&](const WriterOptions& opts) { return WriteBarcodeToSVG(barcode, opts); };
+	auto attr = [](int w) { return "width=\"" + std::to_string(w) + "\" height=\"" + std::to_string(w) + "\""; };
+
+	EXPECT_EQ(svg(WriterOptions()).find("width="), std::string::npos);
+	EXPECT_NE(svg(WriterOptions().scale(3)).find(attr(3 * size)), std::string::npos);
+	EXPECT_NE(svg(WriterOptions().sizeHint(200)).find(attr(200 / size * size)), std::string::npos);
+	EXPECT_NE(svg(WriterOptions().sizeHint(10)).find(attr(size)), std::string::npos);
+	EXPECT_NE(svg(WriterOptions().scale(2).sizeHint(200)).find(attr(2 * size)), std::string::npos);
+}
+
+TEST(BarcodeCacheTest, HitsAndMisses)
+{
+	BarcodeCache cache(4);
+	auto opts = CreatorOptions(BarcodeFormat::QRCode);
+
+	auto a = cache.createFromText("A", opts);
+	EXPECT_EQ(a->text(), "A");
+	EXPECT_EQ(cache.hits(), 0);
+	EXPECT_EQ(cache.misses(), 1);
+
+	EXPECT_EQ(cache.createFromText("A", opts), a);
+	EXPECT_EQ(cache.hits(), 1);
+	EXPECT_EQ(cache.misses(), 1);
+
+	// the same bytes as binary content are a different barcode
+	auto b = cache.createFromBytes("A", 1, opts);
+	EXPECT_NE(b, a);
+	EXPECT_EQ(cache.createFromBytes("A", 1, opts), b);
+	EXPECT_EQ(cache.hits(), 2);
+	EXPECT_EQ(cache.misses(), 2);
+	EXPECT_EQ(cache.size(), 2);
+
+	cache.clear();
+	EXPECT_EQ(cache.size(), 0);
+	EXPECT_NE(cache.createFromText("A", opts), a);
+	EXPECT_EQ(cache.misses(), 3);
+	EXPECT_EQ(a->text(), "A"); // returned barcodes outlive their cache entry
+}
+
+TEST(BarcodeCacheTest, EvictionOrder)
+{
+	BarcodeCache cache(2);
+	auto opts = CreatorOptions(BarcodeFormat::QRCode);
+
+	auto a = cache.createFromText("A", opts);
+	auto b = cache.createFromText("B", opts);
+	EXPECT_EQ(cache.createFromText("A", opts), a); // A is now more recently used than B
+	auto c = cache.createFromText("C", opts);      // so B gets dropped
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_EQ(cache.misses(), 3);
+
+	EXPECT_EQ(cache.createFromText("A", opts), a);
+	EXPECT_EQ(cache.createFromText("C", opts), c);
+	EXPECT_EQ(cache.misses(), 3);
+	EXPECT_NE(cache.createFromText("B", opts), b); // recreated, drops A
+	EXPECT_EQ(cache.misses(), 4);
+	EXPECT_EQ(cache.createFromText("C", opts), c);
+	EXPECT_NE(cache.createFromText("A", opts), a);
+	EXPECT_EQ(cache.misses(), 5);
+	EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(BarcodeCacheTest, ZeroCapacity)
+{
+	BarcodeCache cache(0);
+	auto opts = CreatorOptions(BarcodeFormat::QRCode);
+
+	auto a = cache.createFromText("A", opts);
+	EXPECT_EQ(a->text(), "A");
+	EXPECT_NE(cache.createFromText("A", opts), a);
+	EXPECT_EQ(cache.capacity(), 0);
+	EXPECT_EQ(cache.size(), 0);
+	EXPECT_EQ(cache.hits(), 0);
+	EXPECT_EQ(cache.misses(), 2);
+}
+
+TEST(BarcodeCacheTest, OptionsAreKey)
+{
+	BarcodeCache cache(16);
+	const std::string text = "12345";
+
+	// the same content with different options must never be answered by the same entry
+	std::vector<CreatorOptions> options;
+	options.push_back(CreatorOptions(BarcodeFormat::QRCode));
+	options.push_back(CreatorOptions(BarcodeFormat::QRCode).ecLevel("8"));
+	options.push_back(CreatorOptions(BarcodeFormat::QRCode).readerInit(true));
+	options.push_back(CreatorOptions(BarcodeFormat::QRCode).optimizeSegments(true).ecLevel("2"));
+	options.push_back(CreatorOptions(BarcodeFormat::PDF417));
+	options.push_back(CreatorOptions(BarcodeFormat::DataMatrix));
+	options.push_back(CreatorOptions(BarcodeFormat::DataMatrix).forceSquareDataMatrix(true));
+	options.push_back(CreatorOptions(BarcodeFormat::Aztec).verify(true));
+
+	std::vector<std::shared_ptr<const Barcode>> barcodes;
+	for (auto& opts : options) {
+		auto barcode = cache.createFromText(text, opts);
+		EXPECT_EQ(barcode->format(), opts.format());
+		EXPECT_EQ(barcode->text(), text);
+		for (auto& other : barcodes)
+			EXPECT_NE(barcode, other) << ToString(opts.format());
+		barcodes.push_back(barcode);
+	}
+	EXPECT_EQ(cache.misses(), Size(options));
+	EXPECT_EQ(cache.hits(), 0);
+	EXPECT_EQ(barcodes[1]->ecLevel(), "H");
+
+	// each one is found again with its own options
+	for (int i = 0; i < Size(options); ++i)
+		EXPECT_EQ(cache.createFromText(text, options[i]), barcodes[i]) << i;
+	EXPECT_EQ(cache.hits(), Size(options));
+
+	// the thread count does not influence the result
+	EXPECT_EQ(cache.createFromText(text, CreatorOptions(BarcodeFormat::QRCode).maxThreadCount(4)), barcodes[0]);
+}
+
+TEST(BarcodeCacheTest, Concurrent)
+{
+	BarcodeCache cache(5);
+	const int threadCount = 8, callCount = 200, textCount = 10;
+
+	std::vector<std::thread> threads;
+	std::atomic<int> mismatches = 0;
+	for (int t = 0; t < threadCount; ++t)
+		threads.emplace_back([&, t] {
+			for (int n = 0; n < callCount; ++n) {
+				auto text = "TEXT " + std::to_string((t + n * 7) % textCount);
+				auto barcode = cache.createFromText(text, CreatorOptions(BarcodeFormat::QRCode));
+				if (!barcode || barcode->text() != text)
+					++mismatches;
+			}
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_EQ(cache.hits() + cache.misses(), threadCount * callCount);
+	EXPECT_LE(cache.size(), cache.capacity());
+}
+
+TEST(WriteBarcodeTest, MaxiCodeModuleGrid)
+{
+	// a MaxiCode Barcode without zint_symbol (e.g. a reader result) only knows the module grid, which is written as is
+	BitMatrix grid(30, 33);
+	grid.set(1, 1);
+	auto barcode = Barcode(DecoderResult(), DetectorResult(std::move(grid), {}), BarcodeFormat::MaxiCode);
+	ASSERT_TRUE(barcode.symbol().data());
+
+	std::vector<uint8_t> buffer(100 * 100, 128);
+	EXPECT_FALSE(WriteBarcodeToUtf8(barcode).empty());
+	auto written = WriteBarcodeToBuffer(barcode, buffer.data(), 100, 100, ImageFormat::Lum, 0, 0, 0);
+	EXPECT_EQ(written.width(), 30);
+	EXPECT_EQ(*written.data(1, 1), 0);
+	EXPECT_TRUE(WriteBarcodeToImage(barcode).data());
+	EXPECT_NE(WriteBarcodeToSVG(barcode).find("<path"), std::string::npos);
+}
@@ -8,6 +8,7 @@
 #include "CharacterSet.h"
 #include "DecoderResult.h"
 #include "PseudoRandom.h"
+#include "ReadBarcode.h"
 #include "TextEncoder.h"
 #include "aztec/AZDecoder.h"
 #include "aztec/AZDetector.h"
@@ -16,7 +17,9 @@
 #include "aztec/AZWriter.h"
 
 #include <algorithm>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace testing {
 	namespace internal {
@@ -242,4 +245,67 @@ TEST(AZEncodeDecodeTest, RunePure)
 		EXPECT_EQ(result.nbDatablocks(), 0);
 		EXPECT_EQ(result.runeValue(), word);
 	}
-}
\ No newline at end of file
+}
+
+TEST(AZEncodeDecodeTest, MultipleCompactSymbols)
+{
+	// a 'ticket sheet' with a grid of small compact symbols of varying module size, found in one tryHarder pass
+	constexpr int COLS = 5, ROWS = 4, CELL = 120;
+	BitMatrix sheet(COLS * CELL, ROWS * CELL);
+	std::vector<std::string> expected;
+	for (int i = 0; i < COLS * ROWS; ++i) {
+		auto data = "Ticket #" + std::to_string(1000 + 37 * i);
+		auto aztec = Aztec::Encoder::Encode(data, 25, Aztec::Encoder::DEFAULT_AZTEC_LAYERS);
+		ASSERT_TRUE(aztec.compact);
+		int scale = 2 + i % 3;
+		auto symbol = Inflate(std::move(aztec.matrix), aztec.matrix.width() * scale, aztec.matrix.height() * scale, 0);
+		int left = (i % COLS) * CELL + (CELL - symbol.width()) / 2 + i % 4;
+		int top = (i / COLS) * CELL + (CELL - symbol.height()) / 2 + i % 5;
+		for (int y = 0; y < symbol.height(); ++y)
+			for (int x = 0; x < symbol.width(); ++x)
+				if (symbol.get(x, y))
+					sheet.set(left + x, top + y);
+		expected.push_back(data);
+	}
+	std::sort(expected.begin(), expected.end());
+
+	auto detRess = Aztec::Detect(sheet, false, true, 0);
+	std::vector<std::string> found;
+	for (auto& detRes : detRess) {
+		auto decRes = Aztec::Decode(detRes);
+		EXPECT_TRUE(decRes.isValid());
+		found.push_back(decRes.content().utf8());
+	}
+	std::sort(found.begin(), found.end());
+	EXPECT_EQ(found, expected);
+}
+
+TEST(AZEncodeDecodeTest, SpeckledBullseye)
+{
+	// a single flipped pixel above the center breaks the ring counts of the tryHarder scan on the row where the center
+	// module shows up, so the reader has to fall back to the PatternRow scan
+	auto aztec = Aztec::Encoder::Encode(std::string("Speckle test 12345"), 25, Aztec::Encoder::DEFAULT_AZTEC_LAYERS);
+	constexpr int SCALE = 4, QUIET = 20;
+	const int size = aztec.matrix.width() * SCALE + 2 * QUIET;
+	BitMatrix symbol(size, size);
+	for (int y = 0; y < size - 2 * QUIET; ++y)
+		for (int x = 0; x < size - 2 * QUIET; ++x)
+			if (aztec.matrix.get(x / SCALE, y / SCALE))
+				symbol.set(QUIET + x, QUIET + y);
+	symbol.flip(size / 2, size / 2 - 14);
+
+	auto isDecodable = [&](bool patternRowScan) {
+		auto detRess = Aztec::Detect(symbol, false, true, 0, patternRowScan);
+		return std::any_of(detRess.begin(), detRess.end(), [](auto& detRes) { return Aztec::Decode(detRes).isValid(); });
+	};
+	EXPECT_FALSE(isDecodable(false));
+	EXPECT_TRUE(isDecodable(true));
+
+	std::vector<uint8_t> buffer(size * size);
+	for (int y = 0; y < size; ++y)
+		for (int x = 0; x < size; ++x)
+			buffer[y * size + x] = symbol.get(x, y) ? 0 : 255;
+	auto res = ReadBarcode({buffer.data(), size, size, ImageFormat::Lum},
+						   ReaderOptions().setFormats(BarcodeFormat::Aztec).setTryHarder(true).setBinarizer(Binarizer::BoolCast));
+	EXPECT_EQ(res.text(), "Speckle test 12345");
+}
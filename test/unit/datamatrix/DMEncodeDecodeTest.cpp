@@ -9,6 +9,8 @@
 #include "datamatrix/DMDecoder.h"
 #include "datamatrix/DMWriter.h"
 
+#include "Utf.h"
+
 #include "gtest/gtest.h"
 
 using namespace ZXing;
@@ -32,6 +34,30 @@ namespace {
 									<< matrix.width() << ", shape: " << static_cast<int>(shape) << "\n"
 									<< (matrix.width() < 80 ? ToString(matrix) : std::string());
 	}
+
+	// encode data with the minimal and with the look-ahead encoder, both have to decode and the minimal one
+	// must not result in a larger symbol
+	void TestEncodeDecodeMinimal(const std::wstring& data, DataMatrix::SymbolShape shape, int expectedWidth = 0)
+	{
+		BitMatrix minimal = DataMatrix::Writer().setMargin(0).setShapeHint(shape).setMinimalEncoding(true).encode(data, 0, 0);
+		BitMatrix heuristic = DataMatrix::Writer().setMargin(0).setShapeHint(shape).encode(data, 0, 0);
+		ASSERT_EQ(minimal.empty(), false);
+		ASSERT_EQ(heuristic.empty(), false);
+
+		DecoderResult res = DataMatrix::Decode(minimal);
+#ifndef NDEBUG
+		if (!res.isValid() || data != res.text())
+			SaveAsPBM(minimal, "failed-datamatrix-minimal.pbm", 4);
+#endif
+		ASSERT_EQ(res.isValid(), true) << "text: " << ToUtf8(data) << ", code size: " << minimal.height() << "x"
+									   << minimal.width() << ", shape: " << static_cast<int>(shape);
+		EXPECT_EQ(data, res.text()) << "text: " << ToUtf8(data) << ", shape: " << static_cast<int>(shape);
+		EXPECT_LE(minimal.width() * minimal.height(), heuristic.width() * heuristic.height())
+			<< "text: " << ToUtf8(data) << ", shape: " << static_cast<int>(shape);
+		if (expectedWidth) {
+			EXPECT_EQ(minimal.width(), expectedWidth) << "text: " << ToUtf8(data);
+		}
+	}
 }
 
 TEST(DMEncodeDecodeTest, EncodeDecodeSquare)
@@ -107,3 +133,24 @@ TEST(DMEncodeDecodeTest, EDIFACTWithEOD)
 			TestEncodeDecode(data, shape);
 }
 
+TEST(DMEncodeDecodeTest, EncodeDecodeMinimal)
+{
+	using namespace DataMatrix;
+	std::wstring text[] = {
+		L"Abc123!",
+		L"Lorem ipsum. http://test/",
+		L"AIMAIMAIMAIMaimaimaim1234567890AIM",
+		L"*CH/GN1/022/00ABC<->ABCDE\r",
+		L"<ABCDEFG><ABCDEFGK>:;=?@ABCDEFGH",
+		L"12345678901234567890abcdef:;<=>?@ABCDEFGHIJ+-/1234",
+	};
+	for (auto& data : text)
+		for (size_t len = 1; len <= data.size(); ++len)
+			for (auto shape : {SymbolShape::NONE, SymbolShape::SQUARE, SymbolShape::RECTANGLE})
+				TestEncodeDecodeMinimal(data.substr(0, len), shape);
+
+	// C40 + Text needs 18 codewords, the look-ahead heuristic ends up with 22
+	TestEncodeDecode(L"ABCDEFGHIJ.abcdefghij", SymbolShape::SQUARE);
+	EXPECT_EQ(Writer().setMargin(0).setShapeHint(SymbolShape::SQUARE).encode(L"ABCDEFGHIJ.abcdefghij", 0, 0).width(), 20);
+	TestEncodeDecodeMinimal(L"ABCDEFGHIJ.abcdefghij", SymbolShape::SQUARE, 18);
+}
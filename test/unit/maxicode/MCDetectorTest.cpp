@@ -0,0 +1,207 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "GenericGF.h"
+#include "ReadBarcode.h"
+#include "ReedSolomonEncoder.h"
+#include "maxicode/MCBitMatrixParser.h"
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::MaxiCode;
+
+namespace {
+
+constexpr auto std_numbers_pi_v = 3.14159265358979323846; // TODO: c++20 <numbers>
+constexpr double ROW_PITCH = 0.8660254;
+constexpr double ROW_OFFSET = 0.5773503;
+
+PointF ModuleCenter(int x, int y)
+{
+	return {x + 0.5 + 0.5 * (y & 1), y * ROW_PITCH + ROW_OFFSET};
+}
+
+// Builds the module matrix of a mode 4 symbol containing text made of upper case letters, digits and spaces (Code Set A)
+BitMatrix EncodeMode4(std::string_view text)
+{
+	std::vector<int> message = {4};
+	for (char c : text)
+		message.push_back(c == ' ' ? 32 : c <= '9' ? c : c - 'A' + 1);
+	message.resize(94, 33); // pad
+
+	std::vector<int> codewords(144);
+	std::vector<int> primary(message.begin(), message.begin() + 10);
+	primary.resize(20);
+	ReedSolomonEncode(GenericGF::MaxiCodeField64(), primary, 10);
+	std::copy(primary.begin(), primary.end(), codewords.begin());
+	for (int parity : {0, 1}) {
+		std::vector<int> secondary;
+		for (int i = 0; i < 42; ++i)
+			secondary.push_back(message[10 + 2 * i + parity]);
+		secondary.resize(62);
+		ReedSolomonEncode(GenericGF::MaxiCodeField64(), secondary, 20);
+		for (int i = 0; i < 62; ++i)
+			codewords[20 + 2 * i + parity] = secondary[i];
+	}
+
+	// find the codeword bit each module belongs to by letting the BitMatrixParser read single module matrices
+	BitMatrix res(BitMatrixParser::MATRIX_WIDTH, BitMatrixParser::MATRIX_HEIGHT);
+	for (int y = 0; y < res.height(); ++y)
+		for (int x = 0; x < res.width(); ++x) {
+			BitMatrix single(res.width(), res.height());
+			single.set(x, y);
+			auto bytes = BitMatrixParser::ReadCodewords(single);
+			for (int i = 0; i < Size(bytes); ++i)
+				if (bytes[i] && (codewords[i] & bytes[i]))
+					res.set(x, y);
+		}
+
+	// dark orientation modules and the 2 dark filler modules in the top right corner
+	for (auto [x, y] : {std::pair{10, 9}, {11, 9}, {11, 10}, {7, 15}, {8, 16}, {20, 16}, {20, 17}, {10, 22}, {10, 23}, {17, 22},
+						{17, 23}, {28, 0}, {29, 0}})
+		res.set(x, y);
+
+	return res;
+}
+
+struct Canvas
+{
+	int width, height;
+	std::vector<uint8_t> data;
+
+	Canvas(int width, int height) : width(width), height(height), data(width * height, 0xff) {}
+
+	// draws the symbol with module size X, the bullseye at center and rotated clockwise by angle degrees, the image is
+	// then squeezed vertically by aspect
+	void draw(const BitMatrix& modules, PointF center, double X, double angle, double aspect = 1)
+	{
+		const auto bullseye = ModuleCenter(14, 16);
+		const double a = angle * std_numbers_pi_v / 180, c = std::cos(a), s = std::sin(a);
+		for (int py = 0; py < height; ++py)
+			for (int px = 0; px < width; ++px) {
+				auto d = PointF(px + 0.5 - center.x, (py + 0.5 - center.y) / aspect);
+				auto p = bullseye + PointF(c * d.x + s * d.y, -s * d.x + c * d.y) / X;
+				if (auto r = distance(p, bullseye); r < 4.5) {
+					if (r > 0.577 && int((r - 0.577) / 0.785) % 2 == 0)
+						data[py * width + px] = 0;
+					continue;
+				}
+				int row = std::lround((p.y - ROW_OFFSET) / ROW_PITCH);
+				double best = 1;
+				bool black = false;
+				for (int y = row - 1; y <= row + 1; ++y)
+					for (int x = int(p.x - 0.5 * (y & 1)) - 1; x <= int(p.x - 0.5 * (y & 1)) + 1; ++x)
+						if (modules.isIn(PointI{x, y}) && distance(p, ModuleCenter(x, y)) < best)
+							best = distance(p, ModuleCenter(x, y)), black = modules.get(x, y);
+				if (best < 0.6 && black)
+					data[py * width + px] = 0;
+			}
+	}
+
+	ImageView view() const { return {data.data(), width, height, ImageFormat::Lum}; }
+};
+
+Barcodes Read(const Canvas& image)
+{
+	return ReadBarcodes(image.view(), ReaderOptions().setFormats(BarcodeFormat::MaxiCode));
+}
+
+} // namespace
+
+TEST(MCDetectorTest, Rotated)
+{
+	auto modules = EncodeMode4("ROTATED MAXICODE 123");
+
+	for (double angle : {0., 17., 90., 135., 200., 333.}) {
+		Canvas image(300, 300);
+		image.draw(modules, {150, 150}, 6, angle);
+		auto res = Read(image);
+		ASSERT_EQ(Size(res), 1) << angle;
+		EXPECT_EQ(res[0].text(), "ROTATED MAXICODE 123");
+		EXPECT_NEAR(res[0].orientation(), angle > 180 ? angle - 360 : angle, 2) << angle;
+
+		// the top left corner of the symbol is 14.5 modules left and 14.43 modules above the bullseye center
+		double a = angle * std_numbers_pi_v / 180;
+		auto tl = PointF(150, 150) + 6 * PointF(-14.5 * std::cos(a) + 14.43 * std::sin(a), -14.5 * std::sin(a) - 14.43 * std::cos(a));
+		EXPECT_LT(distance(PointF(res[0].position().topLeft()), tl), 6) << angle;
+	}
+}
+
+TEST(MCDetectorTest, SmallModules)
+{
+	auto modules = EncodeMode4("SMALL");
+
+	Canvas image(120, 120);
+	image.draw(modules, {60, 60}, 3.5, 8);
+	auto res = Read(image);
+	ASSERT_EQ(Size(res), 1);
+	EXPECT_EQ(res[0].text(), "SMALL");
+}
+
+TEST(MCDetectorTest, Squeezed)
+{
+	auto modules = EncodeMode4("SQUEEZED");
+
+	for (double angle : {0., 30., 75.}) {
+		Canvas image(260, 220);
+		image.draw(modules, {130, 110}, 6, angle, 0.75);
+		auto res = Read(image);
+		ASSERT_EQ(Size(res), 1) << angle;
+		EXPECT_EQ(res[0].text(), "SQUEEZED");
+	}
+}
+
+TEST(MCDetectorTest, MultipleSymbols)
+{
+	Canvas image(500, 260);
+	image.draw(EncodeMode4("FIRST"), {120, 130}, 6, 45);
+	image.draw(EncodeMode4("SECOND"), {380, 130}, 5, 260);
+
+	auto res = Read(image);
+	ASSERT_EQ(Size(res), 2);
+	std::vector<std::string> texts = {res[0].text(), res[1].text()};
+	std::sort(texts.begin(), texts.end());
+	EXPECT_EQ(texts, (std::vector<std::string>{"FIRST", "SECOND"}));
+}
+
+TEST(MCDetectorTest, DecoyInFront)
+{
+	// a symbol with valid finder and orientation modules but unreadable data, placed where it is found first
+	auto decoy = EncodeMode4("DECOY");
+	for (int y : {0, 1, 2, 3, 4, 5, 6, 27, 28, 29, 30, 31, 32})
+		for (int x = 0; x < decoy.width(); ++x)
+			decoy.flip(x, y);
+
+	Canvas image(260, 500);
+	image.draw(decoy, {130, 120}, 6, 0);
+	image.draw(EncodeMode4("BEHIND THE DECOY"), {130, 380}, 6, 10);
+
+	auto res = ReadBarcode(image.view(), ReaderOptions().setFormats(BarcodeFormat::MaxiCode));
+	ASSERT_TRUE(res.isValid());
+	EXPECT_EQ(res.text(), "BEHIND THE DECOY");
+
+	auto ress = ReadBarcodes(image.view(), ReaderOptions().setFormats(BarcodeFormat::MaxiCode).setMaxNumberOfSymbols(1));
+	ASSERT_EQ(Size(ress), 1);
+	EXPECT_EQ(ress[0].text(), "BEHIND THE DECOY");
+}
+
+TEST(MCDetectorTest, Pure)
+{
+	Canvas image(200, 200);
+	image.draw(EncodeMode4("PURE 2024"), {100, 100}, 6, 0);
+
+	auto res = ReadBarcodes(image.view(), ReaderOptions().setFormats(BarcodeFormat::MaxiCode).setIsPure(true));
+	ASSERT_EQ(Size(res), 1);
+	EXPECT_EQ(res[0].text(), "PURE 2024");
+}
@@ -0,0 +1,49 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "pdf417/PDFBarcodeValue.h"
+
+#include "gtest/gtest.h"
+
+using namespace ZXing::Pdf417;
+
+TEST(PDF417BarcodeValueTest, Empty)
+{
+	BarcodeValue bv;
+	EXPECT_EQ(bv.value(), -1);
+	EXPECT_FALSE(bv.isAmbiguous());
+	EXPECT_TRUE(bv.values().empty());
+	EXPECT_EQ(bv.confidence(0), 0);
+}
+
+TEST(PDF417BarcodeValueTest, Votes)
+{
+	BarcodeValue bv;
+	for (int v : {7, 3, 7, 9, 3, 7})
+		bv.setValue(v);
+	EXPECT_EQ(bv.value(), 7);
+	EXPECT_FALSE(bv.isAmbiguous());
+	EXPECT_EQ(bv.values(), std::vector<int>{7});
+	EXPECT_EQ(bv.confidence(7), 3);
+	EXPECT_EQ(bv.confidence(3), 2);
+	EXPECT_EQ(bv.confidence(5), 0);
+}
+
+TEST(PDF417BarcodeValueTest, AmbiguousAndManyValues)
+{
+	BarcodeValue bv;
+	// more different values than are stored inline
+	for (int v : {900, 5, 42, 17, 3, 42, 3, 900, 11})
+		bv.setValue(v);
+	EXPECT_EQ(bv.value(), 3);
+	EXPECT_TRUE(bv.isAmbiguous());
+	EXPECT_EQ(bv.values(), (std::vector<int>{3, 42, 900}));
+	EXPECT_EQ(bv.confidence(11), 1);
+
+	bv.setValue(11);
+	bv.setValue(11);
+	EXPECT_EQ(bv.value(), 11);
+	EXPECT_FALSE(bv.isAmbiguous());
+}
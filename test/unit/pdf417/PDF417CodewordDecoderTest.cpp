@@ -0,0 +1,142 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PseudoRandom.h"
+#include "ZXAlgorithms.h"
+#include "pdf417/PDFCodewordDecoder.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Pdf417;
+
+namespace {
+
+using BarWidths = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
+
+struct Symbol
+{
+	int value;
+	BarWidths widths;
+};
+
+// all valid symbols in ascending order, i.e. in the order of the symbol table
+std::vector<Symbol> AllSymbols()
+{
+	std::vector<Symbol> res;
+	for (int value = 0x10000; value < 0x20000; ++value) {
+		if (CodewordDecoder::GetCodeword(value) == -1)
+			continue;
+		Symbol symbol = {value, {}};
+		int bits = value, bit = bits & 1;
+		for (int j = CodewordDecoder::BARS_IN_MODULE - 1; j >= 0; --j) {
+			while ((bits & 1) == bit) {
+				++symbol.widths[j];
+				bits >>= 1;
+			}
+			bit = bits & 1;
+		}
+		res.push_back(symbol);
+	}
+	return res;
+}
+
+// the linear scan over the ratio table that was used before the trie index, returns the symbol and the number of
+// symbols sharing the smallest error
+std::pair<int, int> LinearClosestSymbol(const std::vector<Symbol>& symbols, const BarWidths& moduleBitCount)
+{
+	int bitCountSum = std::accumulate(moduleBitCount.begin(), moduleBitCount.end(), 0);
+	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios = {};
+	if (bitCountSum > 1)
+		for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; i++)
+			bitCountRatios[i] = moduleBitCount[i] / (float)bitCountSum;
+
+	float bestMatchError = std::numeric_limits<float>::max();
+	int bestMatch = -1, ties = 0;
+	for (auto& symbol : symbols) {
+		float error = 0.0f;
+		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
+			float diff = symbol.widths[k] / 17.f - bitCountRatios[k];
+			error += diff * diff;
+		}
+		if (error < bestMatchError) {
+			bestMatchError = error;
+			bestMatch = symbol.value;
+			ties = 1;
+		} else if (error == bestMatchError) {
+			++ties;
+		}
+	}
+	return {bestMatch, ties};
+}
+
+} // namespace
+
+TEST(PDF417CodewordDecoderTest, AllSymbols)
+{
+	auto symbols = AllSymbols();
+	ASSERT_EQ(symbols.size(), 2787u);
+
+	for (auto& symbol : symbols)
+		for (int scale : {1, 3}) {
+			BarWidths widths;
+			for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; ++i)
+				widths[i] = symbol.widths[i] * scale;
+			ASSERT_EQ(CodewordDecoder::GetClosestDecodedValue(widths), symbol.value);
+		}
+}
+
+TEST(PDF417CodewordDecoderTest, ClosestSymbolLikeLinearScan)
+{
+	auto symbols = AllSymbols();
+	PseudoRandom random(42);
+	int tieCount = 0;
+
+	auto check = [&](const BarWidths& widths) {
+		auto [expected, ties] = LinearClosestSymbol(symbols, widths);
+		tieCount += ties > 1;
+		ASSERT_EQ(CodewordDecoder::GetClosestDecodedValue(widths), expected)
+			<< widths[0] << " " << widths[1] << " " << widths[2] << " " << widths[3] << " " << widths[4] << " "
+			<< widths[5] << " " << widths[6] << " " << widths[7];
+	};
+
+	// module sizes of 2 to 6 pixels with each bar off by up to half a module
+	for (int n = 0; n < 10000; ++n) {
+		auto& symbol = symbols[random.next(0, Size(symbols) - 1)];
+		int scale = random.next(2, 6);
+		BarWidths widths;
+		for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; ++i)
+			widths[i] = std::max(1, symbol.widths[i] * scale + random.next(-scale / 2, scale / 2));
+		check(widths);
+	}
+
+	// one pixel moved between two bars at a module size of 2 pixels, i.e. half way between two symbols
+	for (int n = 0; n < 5000; ++n) {
+		auto& symbol = symbols[random.next(0, Size(symbols) - 1)];
+		int from = random.next(0, CodewordDecoder::BARS_IN_MODULE - 1), to = random.next(0, CodewordDecoder::BARS_IN_MODULE - 1);
+		BarWidths widths;
+		for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; ++i)
+			widths[i] = symbol.widths[i] * 2;
+		if (from == to || widths[from] < 2)
+			continue;
+		--widths[from];
+		++widths[to];
+		check(widths);
+	}
+
+	// degenerated input
+	check({});
+	check({1, 1, 1, 1, 1, 1, 1, 1});
+	check({0, 0, 0, 0, 0, 0, 0, 17});
+
+	// make sure the tie breaking got exercised
+	EXPECT_GT(tieCount, 0);
+}
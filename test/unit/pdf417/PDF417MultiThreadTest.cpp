@@ -0,0 +1,91 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitMatrix.h"
+#include "ReadBarcode.h"
+#include "pdf417/PDFWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ZXing;
+
+static Barcode Read(const Matrix<uint8_t>& image, int maxThreadCount)
+{
+	auto opts = ReaderOptions().setFormats(BarcodeFormat::PDF417).setTryHarder(false).setMaxThreadCount(maxThreadCount);
+	return ReadBarcode({image.data(), image.width(), image.height(), ImageFormat::Lum}, opts);
+}
+
+static std::string LongText()
+{
+	std::string text;
+	for (int i = 0; text.size() < 800; ++i)
+		text += "The quick brown fox jumps over the lazy dog " + std::to_string(i) + ". ";
+	return text;
+}
+
+static void TestThreadCount(const std::string& text, int cols, int rows, int size)
+{
+	auto bits = Pdf417::Writer().setDimensions(cols, cols, rows, rows).encode(text, size, size);
+	auto image = ToMatrix<uint8_t>(bits);
+
+	auto serial = Read(image, 1);
+	ASSERT_TRUE(serial.isValid()) << cols << "x" << rows << " " << size;
+	EXPECT_EQ(serial.text(), text);
+
+	for (int threads : {2, 4}) {
+		auto parallel = Read(image, threads);
+		ASSERT_TRUE(parallel.isValid()) << threads;
+		EXPECT_EQ(parallel.text(), serial.text()) << threads;
+		EXPECT_EQ(parallel.bytes(), serial.bytes()) << threads;
+		EXPECT_EQ(parallel.position(), serial.position()) << threads;
+		EXPECT_EQ(parallel.ecLevel(), serial.ecLevel()) << threads;
+	}
+}
+
+TEST(PDF417MultiThreadTest, SameResultAsSingleThread)
+{
+	// too small to be split into bands: the serial path is taken
+	TestThreadCount("Hello Google", 5, 10, 0);
+
+	auto text = LongText();
+
+	// 240 to 720 image rows, split into 2 to 4 bands
+	TestThreadCount(text, 15, 60, 0);
+	TestThreadCount(text, 15, 60, 2 * 324);
+	TestThreadCount(text, 10, 90, 0); // taller than wide -> rotated by the writer
+}
+
+TEST(PDF417MultiThreadTest, DamageAtBandBorder)
+{
+	// 384x300 pixels, the band borders are at image rows 150 (2 threads) resp. 100 and 200 (3 threads)
+	auto bits = Pdf417::Writer().setDimensions(15, 15, 60, 60).encode(LongText(), 0, 0);
+	ASSERT_EQ(bits.height(), 300);
+
+	struct Rect { int x, y, w, h; uint8_t v; };
+	// the serial scan reads the first one only by locating the codewords below the stripe relative to the ones above,
+	// the second one is not readable at all
+	for (auto [rects, readable] : {std::pair{std::vector<Rect>{{227, 149, 33, 6, 255}, {335, 292, 34, 5, 255}, {343, 178, 39, 3, 255}}, true},
+								   std::pair{std::vector<Rect>{{136, 113, 1, 6, 255}, {107, 253, 3, 5, 255}, {64, 82, 2, 6, 0}}, false}}) {
+		auto image = ToMatrix<uint8_t>(bits);
+		for (auto& r : rects)
+			for (int y = r.y; y < std::min(r.y + r.h, image.height()); ++y)
+				for (int x = r.x; x < std::min(r.x + r.w, image.width()); ++x)
+					image.set(x, y, r.v);
+
+		auto serial = Read(image, 1);
+		EXPECT_EQ(serial.isValid(), readable);
+		for (int threads : {2, 3, 4}) {
+			auto parallel = Read(image, threads);
+			EXPECT_EQ(parallel.isValid(), serial.isValid()) << threads;
+			EXPECT_EQ(parallel.text(), serial.text()) << threads;
+			EXPECT_EQ(parallel.position(), serial.position()) << threads;
+		}
+	}
+}
@@ -7,10 +7,12 @@
 #include "BitArrayUtility.h"
 #include "BitMatrixIO.h"
 #include "CharacterSet.h"
+#include "DecoderResult.h"
 #include "TextDecoder.h"
 #include "Utf.h"
 #include "qrcode/QREncoder.h"
 #include "qrcode/QRCodecMode.h"
+#include "qrcode/QRDecoder.h"
 #include "qrcode/QREncodeResult.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 
@@ -20,6 +22,7 @@ namespace ZXing {
 	namespace QRCode {
 		int GetAlphanumericCode(int code);
 		CodecMode ChooseMode(const std::wstring& content, CharacterSet encoding);
+		std::vector<std::pair<CodecMode, int>> ChooseSegments(const std::wstring& content, CharacterSet encoding, const Version& version);
 		void AppendModeInfo(CodecMode mode, BitArray& bits);
 		void AppendLengthInfo(int numLetters, const Version& version, CodecMode mode, BitArray& bits);
 		void AppendNumericBytes(const std::wstring& content, BitArray& bits);
@@ -110,6 +113,48 @@ TEST(QREncoderTest, ChooseMode)
 	EXPECT_EQ(CodecMode::BYTE, ChooseMode(ShiftJISString({0xe, 0x4, 0x9, 0x5, 0x9, 0x61}), CharacterSet::Unknown));
 }
 
+TEST(QREncoderTest, ChooseSegments)
+{
+	using Segments = std::vector<std::pair<CodecMode, int>>;
+	const auto& v1 = *Version::Model2(1);
+
+	EXPECT_EQ(ChooseSegments(L"0123456789", CharacterSet::ISO8859_1, v1), (Segments{{CodecMode::NUMERIC, 10}}));
+	EXPECT_EQ(ChooseSegments(L"ABC:123", CharacterSet::ISO8859_1, v1), (Segments{{CodecMode::ALPHANUMERIC, 7}}));
+	EXPECT_EQ(ChooseSegments(L"abc", CharacterSet::ISO8859_1, v1), (Segments{{CodecMode::BYTE, 3}}));
+	// a short run of digits is not worth the header of a new segment
+	EXPECT_EQ(ChooseSegments(L"a12b", CharacterSet::ISO8859_1, v1), (Segments{{CodecMode::BYTE, 4}}));
+	EXPECT_EQ(ChooseSegments(L"abcdef0123456789", CharacterSet::ISO8859_1, v1),
+			  (Segments{{CodecMode::BYTE, 6}, {CodecMode::NUMERIC, 10}}));
+	EXPECT_EQ(ChooseSegments(L"order 12345678901234567890 ABC", CharacterSet::ISO8859_1, v1),
+			  (Segments{{CodecMode::BYTE, 6}, {CodecMode::NUMERIC, 20}, {CodecMode::ALPHANUMERIC, 4}}));
+
+	// "日本" followed by digits, Kanji mode is only used with Shift_JIS
+	auto kanji = ShiftJISString({0x93, 0xfa, 0x96, 0x7b}) + L"0123456789";
+	EXPECT_EQ(ChooseSegments(kanji, CharacterSet::Shift_JIS, v1), (Segments{{CodecMode::KANJI, 2}, {CodecMode::NUMERIC, 10}}));
+	EXPECT_EQ(ChooseSegments(kanji, CharacterSet::UTF8, v1), (Segments{{CodecMode::BYTE, 2}, {CodecMode::NUMERIC, 10}}));
+}
+
+TEST(QREncoderTest, EncodeOptimizedSegments)
+{
+	std::wstring content = L"order 12345678901234567890123456789012345678901234567890 ABC";
+	auto single = Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false);
+	auto optimized = Encode(content, ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false, -1, true);
+	EXPECT_EQ(single.version->versionNumber(), 4);
+	EXPECT_EQ(optimized.version->versionNumber(), 3);
+	EXPECT_EQ(optimized.mode, CodecMode::BYTE);
+	EXPECT_EQ(Decode(optimized.matrix).text(), content);
+
+	// with an ECI header and a given version
+	content = L"\u00e9t\u00e9 2024: 0123456789012345";
+	optimized = Encode(content, ErrorCorrectionLevel::Medium, CharacterSet::UTF8, 5, false, -1, true);
+	EXPECT_EQ(optimized.version->versionNumber(), 5);
+	EXPECT_EQ(Decode(optimized.matrix).text(), content);
+
+	// there is no segment to encode
+	EXPECT_THROW(Encode(L"", ErrorCorrectionLevel::Low, CharacterSet::Unknown, 0, false, -1, true), std::invalid_argument);
+	EXPECT_THROW(Encode(L"", ErrorCorrectionLevel::Low, CharacterSet::Unknown, 5, false, -1, true), std::invalid_argument);
+}
+
 TEST(QREncoderTest, Encode)
 {
 	auto qrCode = Encode(L"ABCDEF", ErrorCorrectionLevel::High, CharacterSet::Unknown, 0, false, -1);
@@ -0,0 +1,54 @@
+/*
+* Copyright 2024 Axel Waggershauser
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BitArray.h"
+#include "qrcode/QRErrorCorrectionLevel.h"
+#include "qrcode/QRMaskUtil.h"
+#include "qrcode/QRMatrixUtil.h"
+#include "qrcode/QRVersion.h"
+
+#include "gtest/gtest.h"
+#include <limits>
+#include <random>
+
+using namespace ZXing;
+using namespace ZXing::QRCode;
+
+TEST(QRMaskUtilTest, PackedPenaltyMatchesScalar)
+{
+	std::mt19937 rng(42);
+	for (int dimension : {21, 25, 31, 32, 33, 57, 63, 64, 65, 101, 177}) {
+		for (int density : {2, 5, 50}) {
+			TritMatrix matrix(dimension, dimension);
+			for (int y = 0; y < dimension; ++y)
+				for (int x = 0; x < dimension; ++x)
+					matrix.set(x, y, int(rng() % 100) < density || (density == 50 && rng() % 2));
+			EXPECT_EQ(MaskUtil::CalculateMaskPenalty(MaskUtil::PackedMatrix(matrix)), MaskUtil::CalculateMaskPenalty(matrix))
+				<< dimension << " " << density;
+		}
+	}
+}
+
+TEST(QRMaskUtilTest, ChooseMaskPattern)
+{
+	std::mt19937 rng(7);
+	for (int versionNumber : {1, 2, 7, 20, 40}) {
+		auto& version = *Version::Model2(versionNumber);
+		BitArray bits;
+		for (int i = 0; i < version.totalCodewords(); ++i)
+			bits.appendBits(rng() % 256, 8);
+
+		for (auto ecLevel : {ErrorCorrectionLevel::Low, ErrorCorrectionLevel::High}) {
+			int minPenalty = std::numeric_limits<int>::max(), bestMask = -1;
+			for (int mask = 0; mask < NUM_MASK_PATTERNS; ++mask) {
+				TritMatrix matrix(version.dimension(), version.dimension());
+				BuildMatrix(bits, ecLevel, version, mask, matrix);
+				if (int penalty = MaskUtil::CalculateMaskPenalty(matrix); penalty < minPenalty)
+					minPenalty = penalty, bestMask = mask;
+			}
+			EXPECT_EQ(ChooseMaskPattern(bits, ecLevel, version), bestMask) << versionNumber;
+		}
+	}
+}
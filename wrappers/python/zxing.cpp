@@ -321,7 +321,7 @@ PYBIND11_MODULE(zxingcpp, m)
 		.def_property_readonly("valid", &Barcode::isValid,
 			":return: whether or not barcode is valid (i.e. a symbol was found and decoded)\n"
 			":rtype: bool")
-		.def_property_readonly("text", [](const Barcode& res) { return res.text(); },
+		.def_property_readonly("text", [](const Barcode& res) { return res.textView(); },
 			":return: text of the decoded symbol (see also TextMode parameter)\n"
 			":rtype: str")
 		.def_property_readonly("bytes", [](const Barcode& res) { return py::bytes(res.bytes().asString()); },